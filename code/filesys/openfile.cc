@@ -31,6 +31,7 @@ OpenFile::OpenFile(int sector)
 { 
     hdr = new FileHeader;
     hdr->FetchFrom(sector);
+    headerSector = sector;
     seekPosition = 0;
 }
 
@@ -97,14 +98,20 @@ OpenFile::Write(char *into, int numBytes)
 //	boundary; however the disk only knows how to read/write a whole disk
 //	sector at a time.  Thus:
 //
+//	Sectors wholly inside the request are transferred directly
+//	between the disk and the caller's buffer.  Only the first and last
+//	sectors can be partial, and they go through a sector buffer:
+//
 //	For ReadAt:
-//	   We read in all of the full or partial sectors that are part of the
-//	   request, but we only copy the part we are interested in.
+//	   We read in the whole sector, but we only copy the part we are
+//	   interested in.
 //	For WriteAt:
-//	   We must first read in any sectors that will be partially written,
-//	   so that we don't overwrite the unmodified portion.  We then copy
-//	   in the data that will be modified, and write back all the full
-//	   or partial sectors that are part of the request.
+//	   We must first read in the sector, so that we don't overwrite
+//	   the unmodified portion.  We then copy in the data that will be
+//	   modified, and write the sector back.
+//
+//	So a large, sector-aligned write costs one disk write per sector,
+//	and no copying.
 //
 //	"into" -- the buffer to contain the data to be read from disk 
 //	"from" -- the buffer containing the data to be written to disk 
@@ -117,8 +124,8 @@ int
 OpenFile::ReadAt(char *into, int numBytes, int position)
 {
     int fileLength = hdr->FileLength();
-    int i, firstSector, lastSector, numSectors;
-    char *buf;
+    int i, firstSector, lastSector, start, first, last;
+    char buf[SectorSize];
 
     if ((numBytes <= 0) || (position >= fileLength))
     	return 0; 				// check request
@@ -129,17 +136,19 @@ OpenFile::ReadAt(char *into, int numBytes, int position)
 
     firstSector = divRoundDown(position, SectorSize);
     lastSector = divRoundDown(position + numBytes - 1, SectorSize);
-    numSectors = 1 + lastSector - firstSector;
 
-    // read in all the full and partial sectors that we need
-    buf = new char[numSectors * SectorSize];
-    for (i = firstSector; i <= lastSector; i++)	
-        synchDisk->ReadSector(hdr->ByteToSector(i * SectorSize), 
-					&buf[(i - firstSector) * SectorSize]);
-
-    // copy the part we want
-    bcopy(&buf[position - (firstSector * SectorSize)], into, numBytes);
-    delete [] buf;
+    for (i = firstSector; i <= lastSector; i++) {
+	start = i * SectorSize;
+	first = max(position, start);		// the part we want
+	last = min(position + numBytes, start + SectorSize);
+	if ((last - first) == SectorSize)	// all of it
+	    synchDisk->ReadSector(hdr->ByteToSector(start), 
+					&into[start - position]);
+	else {
+	    synchDisk->ReadSector(hdr->ByteToSector(start), buf);
+	    bcopy(&buf[first - start], &into[first - position], last - first);
+	}
+    }
     return numBytes;
 }
 
@@ -147,9 +156,8 @@ int
 OpenFile::WriteAt(char *from, int numBytes, int position)
 {
     int fileLength = hdr->FileLength();
-    int i, firstSector, lastSector, numSectors;
-    bool firstAligned, lastAligned;
-    char *buf;
+    int i, firstSector, lastSector, start, first, last;
+    char buf[SectorSize];
 
     if ((numBytes <= 0) || (position >= fileLength))
 	return 0;				// check request
@@ -160,28 +168,20 @@ OpenFile::WriteAt(char *from, int numBytes, int position)
 
     firstSector = divRoundDown(position, SectorSize);
     lastSector = divRoundDown(position + numBytes - 1, SectorSize);
-    numSectors = 1 + lastSector - firstSector;
-
-    buf = new char[numSectors * SectorSize];
-
-    firstAligned = (position == (firstSector * SectorSize));
-    lastAligned = ((position + numBytes) == ((lastSector + 1) * SectorSize));
-
-// read in first and last sector, if they are to be partially modified
-    if (!firstAligned)
-        ReadAt(buf, SectorSize, firstSector * SectorSize);	
-    if (!lastAligned && ((firstSector != lastSector) || firstAligned))
-        ReadAt(&buf[(lastSector - firstSector) * SectorSize], 
-				SectorSize, lastSector * SectorSize);	
-
-// copy in the bytes we want to change 
-    bcopy(from, &buf[position - (firstSector * SectorSize)], numBytes);
 
-// write modified sectors back
-    for (i = firstSector; i <= lastSector; i++)	
-        synchDisk->WriteSector(hdr->ByteToSector(i * SectorSize), 
-					&buf[(i - firstSector) * SectorSize]);
-    delete [] buf;
+    for (i = firstSector; i <= lastSector; i++) {
+	start = i * SectorSize;
+	first = max(position, start);		// the part we change
+	last = min(position + numBytes, start + SectorSize);
+	if ((last - first) == SectorSize)	// all of it
+	    synchDisk->WriteSector(hdr->ByteToSector(start), 
+					&from[start - position]);
+	else {					// read-modify-write
+	    synchDisk->ReadSector(hdr->ByteToSector(start), buf);
+	    bcopy(&from[first - position], &buf[first - start], last - first);
+	    synchDisk->WriteSector(hdr->ByteToSector(start), buf);
+	}
+    }
     return numBytes;
 }
 
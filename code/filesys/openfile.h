@@ -52,6 +52,7 @@ class OpenFile {
 		}
 
     int Length() { Lseek(file, 0, 2); return Tell(file); }
+    int FileId() { return ::FileId(file); }	// which UNIX file it is
     
   private:
     int file;
@@ -85,9 +86,13 @@ class OpenFile {
 					// file (this interface is simpler 
 					// than the UNIX idiom -- lseek to 
 					// end of file, tell, lseek back 
+    int FileId() { return headerSector; }
+					// Return a number identifying the 
+					// file: where its header is on disk
     
   private:
     FileHeader *hdr;			// Header for this file 
+    int headerSector;			// Where the header is on disk
     int seekPosition;			// Current position within the file
 };
 
@@ -48,6 +48,7 @@ PendingInterrupt::PendingInterrupt(VoidFunctionPtr func, int param, int time,
     arg = param;
     when = time;
     type = kind;
+    next = NULL;
 }
 
 //----------------------------------------------------------------------
@@ -60,10 +61,12 @@ PendingInterrupt::PendingInterrupt(VoidFunctionPtr func, int param, int time,
 Interrupt::Interrupt()
 {
     level = IntOff;
-    pending = new List();
+    pending = new Heap();
+    freeList = NULL;
     inHandler = FALSE;
     yieldOnReturn = FALSE;
     status = SystemMode;
+    nextDue = NeverDue;
 }
 
 //----------------------------------------------------------------------
@@ -73,9 +76,16 @@ Interrupt::Interrupt()
 
 Interrupt::~Interrupt()
 {
+    PendingInterrupt *toFree;
+
     while (!pending->IsEmpty())
-	delete pending->Remove();
+	delete (PendingInterrupt *) pending->RemoveMin(NULL);
     delete pending;
+    while (freeList != NULL) {
+	toFree = freeList;
+	freeList = freeList->next;
+	delete toFree;
+    }
 }
 
 //----------------------------------------------------------------------
@@ -146,22 +156,34 @@ Interrupt::Enable()
 //	Two things can cause OneTick to be called:
 //		interrupts are re-enabled
 //		a user instruction is executed
+//
+//	"ticks" -- the number of user instructions (or kernel steps) to
+//		account for; more than one when the simulator runs a whole
+//		basic block before checking for interrupts
+//
+//	Most ticks have nothing to do but advance the clock, so until 
+//	the time of the next pending interrupt (nextDue) we skip the
+//	search of the pending list.
 //----------------------------------------------------------------------
 void
-Interrupt::OneTick()
+Interrupt::OneTick(int ticks)
 {
     MachineStatus old = status;
 
 // advance simulated time
     if (status == SystemMode) {
-        stats->totalTicks += SystemTick;
-	stats->systemTicks += SystemTick;
+        stats->totalTicks += ticks * SystemTick;
+	stats->systemTicks += ticks * SystemTick;
     } else {					// USER_PROGRAM
-	stats->totalTicks += UserTick;
-	stats->userTicks += UserTick;
+	stats->totalTicks += ticks * UserTick;
+	stats->userTicks += ticks * UserTick;
     }
     DEBUG('i', "\n== Tick %d ==\n", stats->totalTicks);
 
+    if (stats->totalTicks < nextDue && !yieldOnReturn 
+						&& !DebugIsEnabled('i'))
+	return;				// nothing can be due yet
+
 // check any pending interrupts are now ready to fire
     ChangeLevel(IntOn, IntOff);		// first, turn off interrupts
 					// (interrupt handlers run with
@@ -250,7 +272,10 @@ Interrupt::Halt()
 // 	Arrange for the CPU to be interrupted when simulated time
 //	reaches "now + when".
 //
-//	Implementation: just put it on a sorted list.
+//	Implementation: put it in a heap, sorted by time.  Interrupts
+//	due at the same time happen in the order they were scheduled.
+//	Devices re-schedule all the time, so the PendingInterrupt is
+//	taken from a free list when possible, rather than allocated.
 //
 //	NOTE: the Nachos kernel should not call this routine directly.
 //	Instead, it is only called by the hardware device simulators.
@@ -265,13 +290,26 @@ void
 Interrupt::Schedule(VoidFunctionPtr handler, int arg, int fromNow, IntType type)
 {
     int when = stats->totalTicks + fromNow;
-    PendingInterrupt *toOccur = new PendingInterrupt(handler, arg, when, type);
+    PendingInterrupt *toOccur;
+
+    if (freeList != NULL) {
+	toOccur = freeList;
+	freeList = toOccur->next;
+	toOccur->handler = handler;
+	toOccur->arg = arg;
+	toOccur->when = when;
+	toOccur->type = type;
+	toOccur->next = NULL;
+    } else
+	toOccur = new PendingInterrupt(handler, arg, when, type);
 
     DEBUG('i', "Scheduling interrupt handler the %s at time = %d\n", 
 					intTypeNames[type], when);
     ASSERT(fromNow > 0);
 
-    pending->SortedInsert(toOccur, when);
+    pending->Insert(toOccur, when);
+    if (when < nextDue)
+	nextDue = when;
 }
 
 //----------------------------------------------------------------------
@@ -297,26 +335,28 @@ Interrupt::CheckIfDue(bool advanceClock)
 					// to invoke an interrupt handler
     if (DebugIsEnabled('i'))
 	DumpState();
-    PendingInterrupt *toOccur = 
-		(PendingInterrupt *)pending->SortedRemove(&when);
+    PendingInterrupt *toOccur = (PendingInterrupt *)pending->Min(&when);
 
-    if (toOccur == NULL)		// no pending interrupts
+    if (toOccur == NULL) {		// no pending interrupts
+	nextDue = NeverDue;
 	return FALSE;			
+    }
 
     if (advanceClock && when > stats->totalTicks) {	// advance the clock
 	stats->idleTicks += (when - stats->totalTicks);
 	stats->totalTicks = when;
-    } else if (when > stats->totalTicks) {	// not time yet, put it back
-	pending->SortedInsert(toOccur, when);
+    } else if (when > stats->totalTicks) {	// not time yet, leave it
+	nextDue = when;
 	return FALSE;
     }
 
 // Check if there is nothing more to do, and if so, quit
     if ((status == IdleMode) && (toOccur->type == TimerInt) 
-				&& pending->IsEmpty()) {
-	 pending->SortedInsert(toOccur, when);
+				&& (pending->NumInHeap() == 1)) {
+	 nextDue = when;
 	 return FALSE;
     }
+    (void) pending->RemoveMin(NULL);
 
     DEBUG('i', "Invoking interrupt handler for the %s at time %d\n", 
 			intTypeNames[toOccur->type], toOccur->when);
@@ -331,7 +371,10 @@ Interrupt::CheckIfDue(bool advanceClock)
     (*(toOccur->handler))(toOccur->arg);	// call the interrupt handler
     status = old;				// restore the machine status
     inHandler = FALSE;
-    delete toOccur;
+    toOccur->next = freeList;
+    freeList = toOccur;
+    if (pending->Min(&nextDue) == NULL)
+	nextDue = NeverDue;
     return TRUE;
 }
 
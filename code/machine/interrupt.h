@@ -36,7 +36,7 @@
 #define INTERRUPT_H
 
 #include "copyright.h"
-#include "list.h"
+#include "heap.h"
 
 // Interrupts can be disabled (IntOff) or enabled (IntOn)
 enum IntStatus { IntOff, IntOn };
@@ -52,6 +52,8 @@ enum MachineStatus {IdleMode, SystemMode, UserMode};
 enum IntType { TimerInt, DiskInt, ConsoleWriteInt, ConsoleReadInt, 
 				NetworkSendInt, NetworkRecvInt};
 
+#define NeverDue	0x7fffffff	// nextDue, when nothing is pending
+
 // The following class defines an interrupt that is scheduled
 // to occur in the future.  The internal data structures are
 // left public to make it simpler to manipulate.
@@ -67,6 +69,7 @@ class PendingInterrupt {
     int arg;                    // The argument to the function.
     int when;			// When the interrupt is supposed to fire
     IntType type;		// for debugging
+    PendingInterrupt *next;	// next on the free list, once it has fired
 };
 
 // The following class defines the data structures for the simulation
@@ -98,6 +101,11 @@ class Interrupt {
     MachineStatus getStatus() { return status; } // idle, kernel, user
     void setStatus(MachineStatus st) { status = st; }
 
+    int getNextDue() { return nextDue; }// Simulated time of the earliest
+					// pending interrupt; time can be
+					// advanced up to here without 
+					// anything happening
+
     void DumpState();			// Print interrupt state
     
 
@@ -110,16 +118,22 @@ class Interrupt {
 	int arg, int when, IntType type);// at time ``when''.  This is called
     					// by the hardware device simulators.
     
-    void OneTick();       		// Advance simulated time
+    void OneTick(int ticks = 1);	// Advance simulated time, by "ticks"
+					// instructions' worth
 
   private:
     IntStatus level;		// are interrupts enabled or disabled?
-    List *pending;		// the list of interrupts scheduled
-				// to occur in the future
+    Heap *pending;		// the interrupts scheduled to occur in 
+				// the future, soonest first
+    PendingInterrupt *freeList;	// PendingInterrupts that have fired,
+				// to be re-used by Schedule
     bool inHandler;		// TRUE if we are running an interrupt handler
     bool yieldOnReturn; 	// TRUE if we are to context switch
 				// on return from the interrupt handler
     MachineStatus status;	// idle, kernel mode, user mode
+    int nextDue;		// no interrupt is pending before this time
+				// (it may be earlier than the first one
+				// really pending, but never later)
 
     // these functions are internal to the interrupt simulation code
 
@@ -9,7 +9,11 @@
 
 #include "copyright.h"
 #include "machine.h"
+#include "mipsblock.h"
 #include "system.h"
+#ifdef HOST_SPARC
+#include <strings.h>
+#endif
 
 // Textual names of the exceptions that can be generated by user program
 // execution, for debugging.
@@ -50,9 +54,13 @@ void CheckEndian()
 //
 //	"debug" -- if TRUE, drop into the debugger after each user instruction
 //		is executed.
+//	"blocks" -- if TRUE, simulate user code a basic block at a 
+//		time (see mipsblock.cc).  Ignored when single-stepping
+//		or tracing the machine emulation.
+//	"numTLBEntries" -- number of TLB entries, if there is a TLB
 //----------------------------------------------------------------------
 
-Machine::Machine(bool debug)
+Machine::Machine(bool debug, bool blocks, int numTLBEntries)
 {
     int i;
 
@@ -61,17 +69,33 @@ Machine::Machine(bool debug)
     mainMemory = new char[MemorySize];
     for (i = 0; i < MemorySize; i++)
       	mainMemory[i] = 0;
+    decodeCache = new Instruction[MemorySize / 4];
+    decodeValid = new bool[MemorySize / 4];
+    blockCache = new BasicBlock *[MemorySize / 4];
+    for (i = 0; i < MemorySize / 4; i++)
+	blockCache[i] = NULL;
+    blockValid = new bool[MemorySize / 4];
+    blockCovered = new bool[MemorySize / 4];
+    blockTicks = 0;
+    FlushDecodeCache();
 #ifdef USE_TLB
-    tlb = new TranslationEntry[TLBSize];
-    for (i = 0; i < TLBSize; i++)
+    ASSERT(numTLBEntries > 0);
+    tlbSize = numTLBEntries;
+    tlb = new TranslationEntry[tlbSize];
+    for (i = 0; i < tlbSize; i++)
 	tlb[i].valid = FALSE;
     pageTable = NULL;
 #else	// use linear page table
+    tlbSize = 0;
     tlb = NULL;
     pageTable = NULL;
 #endif
+    currentASID = 0;
+
+    FlushTranslationCache();
 
     singleStep = debug;
+    useBlocks = blocks && !debug && !DebugIsEnabled('m');
     CheckEndian();
 }
 
@@ -83,10 +107,69 @@ Machine::Machine(bool debug)
 Machine::~Machine()
 {
     delete [] mainMemory;
+    delete [] decodeCache;
+    delete [] decodeValid;
+    for (int i = 0; i < MemorySize / 4; i++)
+	delete blockCache[i];
+    delete [] blockCache;
+    delete [] blockValid;
+    delete [] blockCovered;
     if (tlb != NULL)
         delete [] tlb;
 }
 
+//----------------------------------------------------------------------
+// Machine::FlushTranslationCache
+// 	Throw away all of the cached translations.  Translate does this
+//	itself when the page table or TLB pointer changes; the kernel may
+//	also call it, but never has to for correctness.
+//----------------------------------------------------------------------
+
+void
+Machine::FlushTranslationCache()
+{
+    for (int i = 0; i < TransCacheSize; i++)
+	transCache[i].entry = NULL;
+    transCacheTable = (tlb != NULL) ? tlb : pageTable;
+}
+
+//----------------------------------------------------------------------
+// Machine::InvalidateDecodeCache
+// 	Throw away the pre-decoded instructions, and any basic blocks,
+//	for one physical page.  Called when the kernel loads new contents
+//	into the page frame directly, bypassing WriteMem, and by WriteMem
+//	when a store hits a word that is part of a basic block.
+//
+//	"pageFrame" -- the physical page whose contents changed
+//----------------------------------------------------------------------
+
+void
+Machine::InvalidateDecodeCache(int pageFrame)
+{
+    ASSERT((pageFrame >= 0) && (pageFrame < NumPhysPages));
+    bzero(&decodeValid[pageFrame * InstrsPerPage], 
+				InstrsPerPage * sizeof(bool));
+    bzero(&blockValid[pageFrame * InstrsPerPage], 
+				InstrsPerPage * sizeof(bool));
+    bzero(&blockCovered[pageFrame * InstrsPerPage], 
+				InstrsPerPage * sizeof(bool));
+}
+
+//----------------------------------------------------------------------
+// Machine::FlushDecodeCache
+// 	Throw away all of the pre-decoded instructions and basic blocks,
+//	eg, because the translation from virtual to physical pages has
+//	changed.
+//----------------------------------------------------------------------
+
+void
+Machine::FlushDecodeCache()
+{
+    bzero(decodeValid, (MemorySize / 4) * sizeof(bool));
+    bzero(blockValid, (MemorySize / 4) * sizeof(bool));
+    bzero(blockCovered, (MemorySize / 4) * sizeof(bool));
+}
+
 //----------------------------------------------------------------------
 // Machine::RaiseException
 // 	Transfer control to the Nachos kernel from user mode, because
@@ -95,6 +178,10 @@ Machine::~Machine()
 //
 //	"which" -- the cause of the kernel trap
 //	"badVaddr" -- the virtual address causing the trap, if appropriate
+//
+//	If we are in the middle of a basic block, the instructions before
+//	this one are charged to simulated time now, since the kernel 
+//	may never return to the block (eg, if the thread exits).
 //----------------------------------------------------------------------
 
 void
@@ -105,6 +192,11 @@ Machine::RaiseException(ExceptionType which, int badVAddr)
 //  ASSERT(interrupt->getStatus() == UserMode);
     registers[BadVAddrReg] = badVAddr;
     DelayedLoad(0, 0);			// finish anything in progress
+    if (blockTicks > 0) {
+	stats->totalTicks += blockTicks * UserTick;
+	stats->userTicks += blockTicks * UserTick;
+	blockTicks = 0;
+    }
     interrupt->setStatus(SystemMode);
     ExceptionHandler(which);		// interrupts are enabled at this point
     interrupt->setStatus(UserMode);
@@ -35,6 +35,8 @@
 #define NumPhysPages    32
 #define MemorySize 	(NumPhysPages * PageSize)
 #define TLBSize		4		// if there is a TLB, make it small
+					// (the default; see Machine())
+#define InstrsPerPage	(PageSize / 4)	// instruction words in one page
 
 enum ExceptionType { NoException,           // Everything ok!
 		     SyscallException,      // A program executed a system call.
@@ -71,6 +73,9 @@ enum ExceptionType { NoException,           // Everything ok!
 
 #define NumTotalRegs 	40
 
+class BasicBlock;		// a run of pre-decoded instructions; see
+				// mipsblock.h
+
 // The following class defines an instruction, represented in both
 // 	undecoded binary form
 //      decoded to identify
@@ -101,12 +106,13 @@ class Instruction {
 // If we were to implement more of the UNIX system calls, we ought to be
 // able to run Nachos on top of Nachos!
 //
-// The procedures in this class are defined in machine.cc, mipssim.cc, and
-// translate.cc.
+// The procedures in this class are defined in machine.cc, mipssim.cc, 
+// mipsblock.cc, and translate.cc.
 
 class Machine {
   public:
-    Machine(bool debug);	// Initialize the simulation of the hardware
+    Machine(bool debug, bool blocks = FALSE, int numTLBEntries = TLBSize);
+				// Initialize the simulation of the hardware
 				// for running user programs
     ~Machine();			// De-allocate the data structures
 
@@ -123,6 +129,16 @@ class Machine {
 
     void OneInstruction(Instruction *instr); 	
     				// Run one instruction of a user program.
+    bool FetchInstruction(Instruction *instr);
+				// Fetch and decode the instruction at PC,
+				// using the pre-decoded copy if there is
+				// one.  Return FALSE on an exception.
+    bool ExecuteInstruction(Instruction *instr);
+				// Simulate one decoded instruction.
+				// Return FALSE on an exception.
+    void RunBlock(Instruction *instr);
+				// Run the basic block at PC, then advance
+				// simulated time for all of it at once
     void DelayedLoad(int nextReg, int nextVal);  	
 				// Do a pending delayed load (modifying a reg)
     
@@ -139,6 +155,16 @@ class Machine {
     				// and return an exception code if the 
 				// translation couldn't be completed.
 
+    void FlushTranslationCache();
+				// Forget all cached translations, eg, when
+				// switching to another page table
+
+    void InvalidateDecodeCache(int pageFrame);
+    void FlushDecodeCache();	// Forget the pre-decoded instructions
+				// for one physical page, or for all of
+				// memory.  Must be called whenever the
+				// kernel changes code behind our back.
+
     void RaiseException(ExceptionType which, int badVAddr);
 				// Trap to the Nachos kernel, because of a
 				// system call or other exception.  
@@ -178,11 +204,37 @@ class Machine {
 
     TranslationEntry *tlb;		// this pointer should be considered 
 					// "read-only" to Nachos kernel code
+    int tlbSize;			// number of entries in the TLB
+    int currentASID;			// only TLB entries tagged with this
+					// address space id are used
 
     TranslationEntry *pageTable;
     unsigned int pageTableSize;
 
   private:
+    TransCacheEntry transCache[TransCacheSize];
+				// recently used translations, by vpn
+    TranslationEntry *transCacheTable;
+				// the page table or TLB they came from
+
+    Instruction *DecodedWord(int physAddr);
+				// pre-decoded copy of the word at physAddr
+    BasicBlock *BuildBlock(int physAddr);
+				// threaded code for the block at physAddr
+
+    Instruction *decodeCache;	// pre-decoded copy of each word of
+				// mainMemory, indexed by physAddr / 4
+    bool *decodeValid;		// is the matching decodeCache entry
+				// still current?
+
+    bool useBlocks;		// run user code a basic block at a time
+    BasicBlock **blockCache;	// the basic block starting at each word
+				// of mainMemory, or NULL
+    bool *blockValid;		// is the matching blockCache entry current?
+    bool *blockCovered;		// is this word part of any cached block?
+    int blockTicks;		// instructions of the current block already
+				// run, but not yet added to simulated time
+
     bool singleStep;		// drop back into the debugger after each
 				// simulated instruction
     int runUntilTime;		// drop back into the debugger when simulated
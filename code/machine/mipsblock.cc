@@ -0,0 +1,541 @@
+// mipsblock.cc
+//	Basic-block ("threaded code") mode of the MIPS simulator.
+//
+//	Each instruction of a basic block is simulated by a small routine
+//	picked when the block is built, rather than by the switch statement
+//	in Machine::ExecuteInstruction.  The common instructions get their
+//	own routine; everything else goes through GenericOp, which hands
+//	the instruction back to ExecuteInstruction, so that the semantics
+//	of the two modes can never drift apart.
+//
+//	Every routine must have exactly the same effect as the matching
+//	case of ExecuteInstruction: operands are read before the delayed
+//	load of the previous instruction is done, then the delayed load
+//	is done, then the program counters are advanced.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+
+#include "machine.h"
+#include "mipsblock.h"
+#include "mipssim.h"
+#include "system.h"
+
+//----------------------------------------------------------------------
+// Retire
+// 	Finish an instruction that did not trap: do any pending delayed
+//	load, and advance the program counters.
+//
+//	"nextLoadReg", "nextLoadValue" -- the load started by this
+//		instruction, if any
+//	"pcAfter" -- the value of NextPCReg after this instruction
+//----------------------------------------------------------------------
+
+static inline bool
+Retire(Machine *m, int nextLoadReg, int nextLoadValue, int pcAfter)
+{
+    m->DelayedLoad(nextLoadReg, nextLoadValue);
+    m->registers[PrevPCReg] = m->registers[PCReg];
+    m->registers[PCReg] = m->registers[NextPCReg];
+    m->registers[NextPCReg] = pcAfter;
+    return TRUE;
+}
+
+// Shorthand for the handlers below.
+#define REG(x)		(m->registers[op->instr.x])
+#define NEXTPC		(m->registers[NextPCReg])
+#define RETIRE()	Retire(m, 0, 0, NEXTPC + 4)
+
+//----------------------------------------------------------------------
+// Instruction handlers, one per opcode.  See the matching cases in
+//	Machine::ExecuteInstruction.
+//----------------------------------------------------------------------
+
+static bool
+GenericOp(Machine *m, BlockOp *op)
+{
+    return m->ExecuteInstruction(&op->instr);
+}
+
+static bool
+AddiuOp(Machine *m, BlockOp *op)
+{
+    REG(rt) = REG(rs) + op->instr.extra;
+    return RETIRE();
+}
+
+static bool
+AdduOp(Machine *m, BlockOp *op)
+{
+    REG(rd) = REG(rs) + REG(rt);
+    return RETIRE();
+}
+
+static bool
+SubuOp(Machine *m, BlockOp *op)
+{
+    REG(rd) = REG(rs) - REG(rt);
+    return RETIRE();
+}
+
+static bool
+AndOp(Machine *m, BlockOp *op)
+{
+    REG(rd) = REG(rs) & REG(rt);
+    return RETIRE();
+}
+
+static bool
+XorOp(Machine *m, BlockOp *op)
+{
+    REG(rd) = REG(rs) ^ REG(rt);
+    return RETIRE();
+}
+
+static bool
+NorOp(Machine *m, BlockOp *op)
+{
+    REG(rd) = ~(REG(rs) | REG(rt));
+    return RETIRE();
+}
+
+static bool
+AndiOp(Machine *m, BlockOp *op)
+{
+    REG(rt) = REG(rs) & op->imm;
+    return RETIRE();
+}
+
+static bool
+OriOp(Machine *m, BlockOp *op)
+{
+    REG(rt) = REG(rs) | op->imm;
+    return RETIRE();
+}
+
+static bool
+XoriOp(Machine *m, BlockOp *op)
+{
+    REG(rt) = REG(rs) ^ op->imm;
+    return RETIRE();
+}
+
+static bool
+LuiOp(Machine *m, BlockOp *op)
+{
+    REG(rt) = op->imm;
+    return RETIRE();
+}
+
+static bool
+SllOp(Machine *m, BlockOp *op)
+{
+    REG(rd) = REG(rt) << op->instr.extra;
+    return RETIRE();
+}
+
+static bool
+SraOp(Machine *m, BlockOp *op)
+{
+    REG(rd) = REG(rt) >> op->instr.extra;
+    return RETIRE();
+}
+
+static bool
+SrlOp(Machine *m, BlockOp *op)
+{
+    int tmp = REG(rt);		// same as ExecuteInstruction, on purpose
+
+    tmp >>= op->instr.extra;
+    REG(rd) = tmp;
+    return RETIRE();
+}
+
+static bool
+SltOp(Machine *m, BlockOp *op)
+{
+    REG(rd) = (REG(rs) < REG(rt)) ? 1 : 0;
+    return RETIRE();
+}
+
+static bool
+SltuOp(Machine *m, BlockOp *op)
+{
+    REG(rd) = ((unsigned int) REG(rs) < (unsigned int) REG(rt)) ? 1 : 0;
+    return RETIRE();
+}
+
+static bool
+SltiOp(Machine *m, BlockOp *op)
+{
+    REG(rt) = (REG(rs) < op->instr.extra) ? 1 : 0;
+    return RETIRE();
+}
+
+static bool
+SltiuOp(Machine *m, BlockOp *op)
+{
+    REG(rt) = ((unsigned int) REG(rs) < (unsigned int) op->instr.extra) ? 1 : 0;
+    return RETIRE();
+}
+
+static bool
+MfhiOp(Machine *m, BlockOp *op)
+{
+    REG(rd) = m->registers[HiReg];
+    return RETIRE();
+}
+
+static bool
+MfloOp(Machine *m, BlockOp *op)
+{
+    REG(rd) = m->registers[LoReg];
+    return RETIRE();
+}
+
+static bool
+LwOp(Machine *m, BlockOp *op)
+{
+    int addr = REG(rs) + op->instr.extra;
+    int value;
+
+    if (addr & 0x3) {
+	m->RaiseException(AddressErrorException, addr);
+	return FALSE;
+    }
+    if (!m->ReadMem(addr, 4, &value))
+	return FALSE;
+    return Retire(m, op->instr.rt, value, NEXTPC + 4);
+}
+
+static bool
+LbOp(Machine *m, BlockOp *op)
+{
+    int value;
+
+    if (!m->ReadMem(REG(rs) + op->instr.extra, 1, &value))
+	return FALSE;
+    if (value & 0x80)
+	value |= 0xffffff00;
+    else
+	value &= 0xff;
+    return Retire(m, op->instr.rt, value, NEXTPC + 4);
+}
+
+static bool
+LbuOp(Machine *m, BlockOp *op)
+{
+    int value;
+
+    if (!m->ReadMem(REG(rs) + op->instr.extra, 1, &value))
+	return FALSE;
+    return Retire(m, op->instr.rt, value & 0xff, NEXTPC + 4);
+}
+
+static bool
+SwOp(Machine *m, BlockOp *op)
+{
+    if (!m->WriteMem((unsigned) (REG(rs) + op->instr.extra), 4, REG(rt)))
+	return FALSE;
+    return RETIRE();
+}
+
+static bool
+SbOp(Machine *m, BlockOp *op)
+{
+    if (!m->WriteMem((unsigned) (REG(rs) + op->instr.extra), 1, REG(rt)))
+	return FALSE;
+    return RETIRE();
+}
+
+static bool
+BeqOp(Machine *m, BlockOp *op)
+{
+    if (REG(rs) == REG(rt))
+	return Retire(m, 0, 0, NEXTPC + op->imm);
+    return RETIRE();
+}
+
+static bool
+BneOp(Machine *m, BlockOp *op)
+{
+    if (REG(rs) != REG(rt))
+	return Retire(m, 0, 0, NEXTPC + op->imm);
+    return RETIRE();
+}
+
+static bool
+BlezOp(Machine *m, BlockOp *op)
+{
+    if (REG(rs) <= 0)
+	return Retire(m, 0, 0, NEXTPC + op->imm);
+    return RETIRE();
+}
+
+static bool
+BgtzOp(Machine *m, BlockOp *op)
+{
+    if (REG(rs) > 0)
+	return Retire(m, 0, 0, NEXTPC + op->imm);
+    return RETIRE();
+}
+
+static bool
+BltzOp(Machine *m, BlockOp *op)
+{
+    if (REG(rs) & SIGN_BIT)
+	return Retire(m, 0, 0, NEXTPC + op->imm);
+    return RETIRE();
+}
+
+static bool
+BgezOp(Machine *m, BlockOp *op)
+{
+    if (!(REG(rs) & SIGN_BIT))
+	return Retire(m, 0, 0, NEXTPC + op->imm);
+    return RETIRE();
+}
+
+static bool
+BltzalOp(Machine *m, BlockOp *op)
+{
+    m->registers[R31] = NEXTPC + 4;
+    return BltzOp(m, op);
+}
+
+static bool
+BgezalOp(Machine *m, BlockOp *op)
+{
+    m->registers[R31] = NEXTPC + 4;
+    return BgezOp(m, op);
+}
+
+static bool
+JOp(Machine *m, BlockOp *op)
+{
+    return Retire(m, 0, 0, ((NEXTPC + 4) & 0xf0000000) | op->imm);
+}
+
+static bool
+JalOp(Machine *m, BlockOp *op)
+{
+    m->registers[R31] = NEXTPC + 4;
+    return Retire(m, 0, 0, ((NEXTPC + 4) & 0xf0000000) | op->imm);
+}
+
+static bool
+JrOp(Machine *m, BlockOp *op)
+{
+    return Retire(m, 0, 0, REG(rs));
+}
+
+static bool
+JalrOp(Machine *m, BlockOp *op)
+{
+    REG(rd) = NEXTPC + 4;
+    return Retire(m, 0, 0, REG(rs));
+}
+
+//----------------------------------------------------------------------
+// PrepareOp
+// 	Fill in the handler and the pre-computed operand for one
+//	decoded instruction.
+//
+//	Returns TRUE if the instruction ends a basic block once its
+//	delay slot (if it has one) has been added.
+//----------------------------------------------------------------------
+
+static bool
+PrepareOp(BlockOp *op, Instruction *instr, bool *hasDelaySlot)
+{
+    op->instr = *instr;
+    op->imm = 0;
+    op->handler = GenericOp;
+    *hasDelaySlot = FALSE;
+
+    switch (instr->opCode) {
+      case OP_ADDIU:	op->handler = AddiuOp; break;
+      case OP_ADDU:	op->handler = AdduOp; break;
+      case OP_SUBU:	op->handler = SubuOp; break;
+      case OP_AND:	op->handler = AndOp; break;
+      case OP_XOR:	op->handler = XorOp; break;
+      case OP_NOR:	op->handler = NorOp; break;
+      case OP_SLL:	op->handler = SllOp; break;
+      case OP_SRA:	op->handler = SraOp; break;
+      case OP_SRL:	op->handler = SrlOp; break;
+      case OP_SLT:	op->handler = SltOp; break;
+      case OP_SLTU:	op->handler = SltuOp; break;
+      case OP_SLTI:	op->handler = SltiOp; break;
+      case OP_SLTIU:	op->handler = SltiuOp; break;
+      case OP_MFHI:	op->handler = MfhiOp; break;
+      case OP_MFLO:	op->handler = MfloOp; break;
+      case OP_LW:	op->handler = LwOp; break;
+      case OP_LB:	op->handler = LbOp; break;
+      case OP_LBU:	op->handler = LbuOp; break;
+      case OP_SW:	op->handler = SwOp; break;
+      case OP_SB:	op->handler = SbOp; break;
+
+      case OP_ANDI:
+	op->handler = AndiOp;
+	op->imm = instr->extra & 0xffff;
+	break;
+      case OP_ORI:
+	op->handler = OriOp;
+	op->imm = instr->extra & 0xffff;
+	break;
+      case OP_XORI:
+	op->handler = XoriOp;
+	op->imm = instr->extra & 0xffff;
+	break;
+      case OP_LUI:
+	op->handler = LuiOp;
+	op->imm = instr->extra << 16;
+	break;
+
+      case OP_BEQ:	op->handler = BeqOp; break;
+      case OP_BNE:	op->handler = BneOp; break;
+      case OP_BLEZ:	op->handler = BlezOp; break;
+      case OP_BGTZ:	op->handler = BgtzOp; break;
+      case OP_BLTZ:	op->handler = BltzOp; break;
+      case OP_BGEZ:	op->handler = BgezOp; break;
+      case OP_BLTZAL:	op->handler = BltzalOp; break;
+      case OP_BGEZAL:	op->handler = BgezalOp; break;
+      case OP_J:	op->handler = JOp; break;
+      case OP_JAL:	op->handler = JalOp; break;
+      case OP_JR:	op->handler = JrOp; break;
+      case OP_JALR:	op->handler = JalrOp; break;
+
+      case OP_SYSCALL:
+      case OP_RES:
+      case OP_UNIMP:
+	return TRUE;			// always traps; nothing can follow
+
+      default:
+	return FALSE;
+    }
+
+    switch (instr->opCode) {		// control transfers
+      case OP_BEQ: case OP_BNE: case OP_BLEZ: case OP_BGTZ:
+      case OP_BLTZ: case OP_BGEZ: case OP_BLTZAL: case OP_BGEZAL:
+	op->imm = IndexToAddr(instr->extra);
+	*hasDelaySlot = TRUE;
+	return TRUE;
+      case OP_J: case OP_JAL:
+	op->imm = IndexToAddr(instr->extra);
+	*hasDelaySlot = TRUE;
+	return TRUE;
+      case OP_JR: case OP_JALR:
+	*hasDelaySlot = TRUE;
+	return TRUE;
+    }
+    return FALSE;
+}
+
+//----------------------------------------------------------------------
+// Machine::BuildBlock
+// 	Translate the basic block starting at physical address "physAddr"
+//	into threaded code, and remember it in the block cache.
+//
+//	The block is cut short at the end of the page; if that separates
+//	a branch from its delay slot, the delay slot is simulated on its
+//	own by OneInstruction.
+//----------------------------------------------------------------------
+
+BasicBlock *
+Machine::BuildBlock(int physAddr)
+{
+    int slot = physAddr / 4;
+    int end = (physAddr / PageSize + 1) * InstrsPerPage;
+    BasicBlock *block;
+    bool hasDelaySlot, inDelaySlot = FALSE;
+    int w;
+
+    if (blockCache[slot] == NULL)
+	blockCache[slot] = new BasicBlock;
+    block = blockCache[slot];
+    block->length = 0;
+    for (w = slot; w < end; w++) {
+	bool last = PrepareOp(&block->ops[block->length++], DecodedWord(w * 4),
+							&hasDelaySlot);
+	blockCovered[w] = TRUE;
+	if (inDelaySlot)		// the branch's delay slot ends it
+	    break;
+	if (last) {
+	    if (!hasDelaySlot)
+		break;
+	    inDelaySlot = TRUE;
+	}
+    }
+    blockValid[slot] = TRUE;
+    return block;
+}
+
+//----------------------------------------------------------------------
+// Machine::RunBlock
+// 	Simulate the basic block at the current PC, then advance simulated
+//	time once for all of its instructions.
+//
+//	Instructions that are not the start of a straight-line run (ie,
+//	we are in the delay slot of a branch) are simulated one at a time,
+//	as by Run().
+//
+//	The block is also cut short so that simulated time never runs past
+//	the next pending interrupt; it then happens at exactly the same
+//	point in the user program as it would one instruction at a time.
+//
+//	If an instruction traps, the rest of the block is abandoned.  The
+//	time for the instructions before it is charged by RaiseException
+//	(the kernel may never return to us, eg, on Exit), and the trapping
+//	instruction is charged afterwards, just as in Run().
+//
+//	"instr" -- scratch space for single-stepped instructions
+//----------------------------------------------------------------------
+
+void
+Machine::RunBlock(Instruction *instr)
+{
+    int physAddr, slot;
+    ExceptionType exception;
+    BasicBlock *block;
+    BlockOp *op, *end;
+    int budget;
+
+    if (registers[NextPCReg] != registers[PCReg] + 4) {
+	OneInstruction(instr);
+	interrupt->OneTick();
+	return;
+    }
+    exception = Translate(registers[PCReg], &physAddr, 4, FALSE);
+    if (exception != NoException) {
+	RaiseException(exception, registers[PCReg]);
+	interrupt->OneTick();
+	return;
+    }
+    slot = physAddr / 4;
+    if (blockValid[slot])
+	block = blockCache[slot];
+    else
+	block = BuildBlock(physAddr);
+
+    blockTicks = 0;
+    end = &block->ops[block->length];
+    budget = divRoundUp(interrupt->getNextDue() - stats->totalTicks, UserTick);
+    if (budget < 1)
+	budget = 1;
+    if (budget < block->length)
+	end = &block->ops[budget];
+    for (op = block->ops; op < end; op++) {
+	if (!(*op->handler)(this, op)) {
+	    interrupt->OneTick();	// the rest was charged by
+	    return;			// RaiseException
+	}
+	blockTicks++;
+	if (!blockValid[slot])		// the block overwrote itself
+	    break;
+    }
+    interrupt->OneTick(blockTicks);
+    blockTicks = 0;
+}
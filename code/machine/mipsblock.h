@@ -0,0 +1,57 @@
+// mipsblock.h
+//	Data structures for the basic-block ("threaded code") mode of
+//	the MIPS simulator.
+//
+//	Instead of fetching, decoding and dispatching through a big
+//	switch statement one instruction at a time, straight-line runs
+//	of user code are translated once into an array of operations.
+//	Each operation is a pointer to a small routine that does exactly
+//	one kind of instruction, plus its operands, already pulled out
+//	of the instruction word.  The simulator then runs the whole array
+//	before advancing simulated time.
+//
+//	A basic block ends after a branch or jump and its delay slot,
+//	after an instruction that always traps (eg, syscall), or at the
+//	end of a physical page -- blocks never cross a page boundary,
+//	so they can be thrown away a page at a time.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef MIPSBLOCK_H
+#define MIPSBLOCK_H
+
+#include "copyright.h"
+#include "machine.h"
+
+class BlockOp;
+
+// Simulate one instruction of a basic block.  Returns FALSE if the
+// instruction trapped to the kernel (the exception has already been
+// raised), in which case the rest of the block must not be run.
+typedef bool (*BlockHandler)(Machine *machine, BlockOp *op);
+
+#define MaxBlockLength	InstrsPerPage	// blocks never cross a page
+
+// One pre-decoded instruction of a basic block.
+
+class BlockOp {
+  public:
+    BlockHandler handler;	// routine to simulate this instruction
+    int imm;			// immediate operand, already zero-extended
+				// or shifted as the instruction needs it
+    Instruction instr;		// the decoded instruction, for the
+				// register numbers and the general case
+};
+
+// A run of instructions, starting at some physical address, that
+// can be simulated without checking for interrupts in between.
+
+class BasicBlock {
+  public:
+    int length;				// number of ops in the block
+    BlockOp ops[MaxBlockLength];	// the instructions, in order
+};
+
+#endif // MIPSBLOCK_H
@@ -37,8 +37,12 @@ Machine::Run()
 	       currentThread->getName(), stats->totalTicks);
     interrupt->setStatus(UserMode);
     for (;;) {
-        OneInstruction(instr);
-	interrupt->OneTick();
+	if (useBlocks)
+	    RunBlock(instr);
+	else {
+	    OneInstruction(instr);
+	    interrupt->OneTick();
+	}
 	if (singleStep && (runUntilTime <= stats->totalTicks))
 	  Debugger();
     }
@@ -93,16 +97,9 @@ TypeToReg(RegType reg, Instruction *instr)
 void
 Machine::OneInstruction(Instruction *instr)
 {
-    int raw;
-    int nextLoadReg = 0; 	
-    int nextLoadValue = 0; 	// record delayed load operation, to apply
-				// in the future
-
     // Fetch instruction 
-    if (!machine->ReadMem(registers[PCReg], 4, &raw))
+    if (!FetchInstruction(instr))
 	return;			// exception occurred
-    instr->value = raw;
-    instr->Decode();
 
     if (DebugIsEnabled('m')) {
        struct OpString *str = &opStrings[instr->opCode];
@@ -114,6 +111,26 @@ Machine::OneInstruction(Instruction *instr)
        printf("\n");
        }
     
+    (void) ExecuteInstruction(instr);
+}
+
+//----------------------------------------------------------------------
+// Machine::ExecuteInstruction
+// 	Execute an instruction that has already been fetched and decoded,
+//	then do any delayed load and advance the program counters.
+//
+//	Returns FALSE if the instruction raised an exception (in which
+//	case the exception handler has already run, and the PC has not
+//	been advanced past the instruction).
+//----------------------------------------------------------------------
+
+bool
+Machine::ExecuteInstruction(Instruction *instr)
+{
+    int nextLoadReg = 0; 	
+    int nextLoadValue = 0; 	// record delayed load operation, to apply
+				// in the future
+
     // Compute next pc, but don't install in case there's an error or branch.
     int pcAfter = registers[NextPCReg] + 4;
     int sum, diff, tmp, value;
@@ -127,7 +144,7 @@ Machine::OneInstruction(Instruction *instr)
 	if (!((registers[instr->rs] ^ registers[instr->rt]) & SIGN_BIT) &&
 	    ((registers[instr->rs] ^ sum) & SIGN_BIT)) {
 	    RaiseException(OverflowException, 0);
-	    return;
+	    return FALSE;
 	}
 	registers[instr->rd] = sum;
 	break;
@@ -137,7 +154,7 @@ Machine::OneInstruction(Instruction *instr)
 	if (!((registers[instr->rs] ^ instr->extra) & SIGN_BIT) &&
 	    ((instr->extra ^ sum) & SIGN_BIT)) {
 	    RaiseException(OverflowException, 0);
-	    return;
+	    return FALSE;
 	}
 	registers[instr->rt] = sum;
 	break;
@@ -232,7 +249,7 @@ Machine::OneInstruction(Instruction *instr)
       case OP_LBU:
 	tmp = registers[instr->rs] + instr->extra;
 	if (!machine->ReadMem(tmp, 1, &value))
-	    return;
+	    return FALSE;
 
 	if ((value & 0x80) && (instr->opCode == OP_LB))
 	    value |= 0xffffff00;
@@ -247,10 +264,10 @@ Machine::OneInstruction(Instruction *instr)
 	tmp = registers[instr->rs] + instr->extra;
 	if (tmp & 0x1) {
 	    RaiseException(AddressErrorException, tmp);
-	    return;
+	    return FALSE;
 	}
 	if (!machine->ReadMem(tmp, 2, &value))
-	    return;
+	    return FALSE;
 
 	if ((value & 0x8000) && (instr->opCode == OP_LH))
 	    value |= 0xffff0000;
@@ -269,10 +286,10 @@ Machine::OneInstruction(Instruction *instr)
 	tmp = registers[instr->rs] + instr->extra;
 	if (tmp & 0x3) {
 	    RaiseException(AddressErrorException, tmp);
-	    return;
+	    return FALSE;
 	}
 	if (!machine->ReadMem(tmp, 4, &value))
-	    return;
+	    return FALSE;
 	nextLoadReg = instr->rt;
 	nextLoadValue = value;
 	break;
@@ -286,7 +303,7 @@ Machine::OneInstruction(Instruction *instr)
 	ASSERT((tmp & 0x3) == 0);  
 
 	if (!machine->ReadMem(tmp, 4, &value))
-	    return;
+	    return FALSE;
 	if (registers[LoadReg] == instr->rt)
 	    nextLoadValue = registers[LoadValueReg];
 	else
@@ -317,7 +334,7 @@ Machine::OneInstruction(Instruction *instr)
 	ASSERT((tmp & 0x3) == 0);  
 
 	if (!machine->ReadMem(tmp, 4, &value))
-	    return;
+	    return FALSE;
 	if (registers[LoadReg] == instr->rt)
 	    nextLoadValue = registers[LoadValueReg];
 	else
@@ -383,13 +400,13 @@ Machine::OneInstruction(Instruction *instr)
       case OP_SB:
 	if (!machine->WriteMem((unsigned) 
 		(registers[instr->rs] + instr->extra), 1, registers[instr->rt]))
-	    return;
+	    return FALSE;
 	break;
 	
       case OP_SH:
 	if (!machine->WriteMem((unsigned) 
 		(registers[instr->rs] + instr->extra), 2, registers[instr->rt]))
-	    return;
+	    return FALSE;
 	break;
 	
       case OP_SLL:
@@ -459,7 +476,7 @@ Machine::OneInstruction(Instruction *instr)
 	if (((registers[instr->rs] ^ registers[instr->rt]) & SIGN_BIT) &&
 	    ((registers[instr->rs] ^ diff) & SIGN_BIT)) {
 	    RaiseException(OverflowException, 0);
-	    return;
+	    return FALSE;
 	}
 	registers[instr->rd] = diff;
 	break;
@@ -471,7 +488,7 @@ Machine::OneInstruction(Instruction *instr)
       case OP_SW:
 	if (!machine->WriteMem((unsigned) 
 		(registers[instr->rs] + instr->extra), 4, registers[instr->rt]))
-	    return;
+	    return FALSE;
 	break;
 	
       case OP_SWL:	  
@@ -482,7 +499,7 @@ Machine::OneInstruction(Instruction *instr)
 	ASSERT((tmp & 0x3) == 0);  
 
 	if (!machine->ReadMem((tmp & ~0x3), 4, &value))
-	    return;
+	    return FALSE;
 	switch (tmp & 0x3) {
 	  case 0:
 	    value = registers[instr->rt];
@@ -501,7 +518,7 @@ Machine::OneInstruction(Instruction *instr)
 	    break;
 	}
 	if (!machine->WriteMem((tmp & ~0x3), 4, value))
-	    return;
+	    return FALSE;
 	break;
     	
       case OP_SWR:	  
@@ -512,7 +529,7 @@ Machine::OneInstruction(Instruction *instr)
 	ASSERT((tmp & 0x3) == 0);  
 
 	if (!machine->ReadMem((tmp & ~0x3), 4, &value))
-	    return;
+	    return FALSE;
 	switch (tmp & 0x3) {
 	  case 0:
 	    value = (value & 0xffffff) | (registers[instr->rt] << 24);
@@ -528,12 +545,12 @@ Machine::OneInstruction(Instruction *instr)
 	    break;
 	}
 	if (!machine->WriteMem((tmp & ~0x3), 4, value))
-	    return;
+	    return FALSE;
 	break;
     	
       case OP_SYSCALL:
 	RaiseException(SyscallException, 0);
-	return; 
+	return FALSE;
 	
       case OP_XOR:
 	registers[instr->rd] = registers[instr->rs] ^ registers[instr->rt];
@@ -546,7 +563,7 @@ Machine::OneInstruction(Instruction *instr)
       case OP_RES:
       case OP_UNIMP:
 	RaiseException(IllegalInstrException, 0);
-	return;
+	return FALSE;
 	
       default:
 	ASSERT(FALSE);
@@ -562,6 +579,59 @@ Machine::OneInstruction(Instruction *instr)
 						// are jumping into lala-land
     registers[PCReg] = registers[NextPCReg];
     registers[NextPCReg] = pcAfter;
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// Machine::FetchInstruction
+// 	Fetch the instruction at the current PC into "instr", already
+//	decoded.
+//
+//	Tight loops execute the same few words over and over, so rather
+//	than going through ReadMem and Decode every time, we keep a 
+//	decoded copy of every instruction word we have executed, indexed
+//	by its physical address.  The copy is thrown away when the word
+//	is overwritten (WriteMem), or when the kernel changes the
+//	contents or the mapping of user memory (InvalidateDecodeCache,
+//	FlushDecodeCache).
+//
+//	Returns FALSE if the translation of the PC failed; the exception
+//	has already been raised.
+//----------------------------------------------------------------------
+
+bool
+Machine::FetchInstruction(Instruction *instr)
+{
+    int physAddr;
+    ExceptionType exception;
+
+    exception = Translate(registers[PCReg], &physAddr, 4, FALSE);
+    if (exception != NoException) {
+	RaiseException(exception, registers[PCReg]);
+	return FALSE;
+    }
+    *instr = *DecodedWord(physAddr);
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// Machine::DecodedWord
+// 	Return the decoded form of the instruction word at physical
+//	address "physAddr", decoding it if this is the first time.
+//----------------------------------------------------------------------
+
+Instruction *
+Machine::DecodedWord(int physAddr)
+{
+    int slot = physAddr / 4;
+
+    if (!decodeValid[slot]) {		// first time here, decode it
+	decodeCache[slot].value = 
+		WordToHost(*(unsigned int *) &mainMemory[physAddr]);
+	decodeCache[slot].Decode();
+	decodeValid[slot] = TRUE;
+    }
+    return &decodeCache[slot];
 }
 
 //----------------------------------------------------------------------
@@ -19,9 +19,15 @@
 Statistics::Statistics()
 {
     totalTicks = idleTicks = systemTicks = userTicks = 0;
+    numContextSwitches = 0;
+    numThreadAllocs = numThreadPoolHits = numPooledThreads = 0;
+    numStackAllocs = numStackPoolHits = numPooledStacks = 0;
     numDiskReads = numDiskWrites = 0;
     numConsoleCharsRead = numConsoleCharsWritten = 0;
-    numPageFaults = numPacketsSent = numPacketsRecvd = 0;
+    numPageFaults = numPageOuts = numPacketsSent = numPacketsRecvd = 0;
+    numTLBLookups = numTLBMisses = numCopyOnWrites = 0;
+    numZeroFills = numZeroPagesUntouched = 0;
+    numExecs = execTicks = maxExecTicks = 0;
 }
 
 //----------------------------------------------------------------------
@@ -35,10 +41,26 @@ Statistics::Print()
 {
     printf("Ticks: total %d, idle %d, system %d, user %d\n", totalTicks, 
 	idleTicks, systemTicks, userTicks);
+    printf("Scheduling: context switches %d\n", numContextSwitches);
+    if (numStackAllocs > 0)
+	printf("Thread pool: threads %d (%.2f%% reused), stacks %d (%.2f%% "
+	    "reused), pooled now %d and %d\n", numThreadAllocs,
+	    100.0 * numThreadPoolHits / numThreadAllocs, numStackAllocs,
+	    100.0 * numStackPoolHits / numStackAllocs, numPooledThreads,
+	    numPooledStacks);
     printf("Disk I/O: reads %d, writes %d\n", numDiskReads, numDiskWrites);
     printf("Console I/O: reads %d, writes %d\n", numConsoleCharsRead, 
 	numConsoleCharsWritten);
-    printf("Paging: faults %d\n", numPageFaults);
+    printf("Paging: faults %d, page outs %d, copy-on-write copies %d\n", 
+	numPageFaults, numPageOuts, numCopyOnWrites);
+    printf("Zero-fill: pages filled %d, never touched %d\n", numZeroFills,
+	numZeroPagesUntouched);
+    if (numExecs > 0)
+	printf("Exec: programs %d, ticks to first instruction avg %d, max %d\n",
+	    numExecs, execTicks / numExecs, maxExecTicks);
+    if (numTLBLookups > 0)
+	printf("TLB: lookups %d, misses %d, hit rate %.2f%%\n", numTLBLookups,
+	    numTLBMisses, 100.0 * (numTLBLookups - numTLBMisses) / numTLBLookups);
     printf("Network I/O: packets received %d, sent %d\n", numPacketsRecvd, 
 	numPacketsSent);
 }
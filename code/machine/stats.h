@@ -28,11 +28,33 @@ class Statistics {
 				// (this is also equal to # of
 				// user instructions executed)
 
+    int numContextSwitches;	// number of times a thread was dispatched
+    int numThreadAllocs;	// number of Thread objects allocated
+    int numThreadPoolHits;	// number of those taken from the pool
+    int numPooledThreads;	// number of Thread objects in the pool now
+    int numStackAllocs;		// number of thread stacks allocated
+    int numStackPoolHits;	// number of those taken from the pool
+    int numPooledStacks;	// number of stacks in the pool now
+
     int numDiskReads;		// number of disk read requests
     int numDiskWrites;		// number of disk write requests
     int numConsoleCharsRead;	// number of characters read from the keyboard
     int numConsoleCharsWritten; // number of characters written to the display
     int numPageFaults;		// number of virtual memory page faults
+    int numPageOuts;		// number of dirty pages written to the
+				// backing store
+    int numZeroFills;		// number of uninitialized data or stack 
+				// pages zeroed when first touched
+    int numZeroPagesUntouched;	// number of those never touched, by the
+				// time their address space went away
+    int numCopyOnWrites;	// number of pages copied, after a Fork,
+				// because they were written
+    int numExecs;		// number of programs started by Exec
+    int execTicks;		// total time from their Exec calls to their
+				// first instructions
+    int maxExecTicks;		// the longest of those
+    int numTLBLookups;		// number of translations done by the TLB
+    int numTLBMisses;		// number of those that missed
     int numPacketsSent;		// number of packets sent over the network
     int numPacketsRecvd;	// number of packets received over the network
 
@@ -36,6 +36,7 @@ extern "C" {
 #include <sys/file.h>
 #include <sys/un.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
 #ifdef HOST_i386
 #include <unistd.h>
 #include <sys/time.h>
@@ -243,6 +244,23 @@ Tell(int fd)
 }
 
 
+//----------------------------------------------------------------------
+// FileId
+// 	Return a number that identifies the file (not just this open of
+//	it) -- its i-number.
+//----------------------------------------------------------------------
+
+int 
+FileId(int fd)
+{
+    struct stat buf;
+    int retVal = fstat(fd, &buf);
+
+    ASSERT(retVal >= 0);
+    return (int) buf.st_ino;
+}
+
+
 //----------------------------------------------------------------------
 // Close
 // 	Close a file.  Abort on error.
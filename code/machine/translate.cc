@@ -129,6 +129,9 @@ Machine::ReadMem(int addr, int size, int *value)
 //   	Returns FALSE if the translation step from virtual to physical memory
 //   	failed.
 //
+//	If the word we overwrite has been pre-decoded, the decoded copy
+//	is thrown away, so self-modifying code still works.
+//
 //	"addr" -- the virtual address to write to
 //	"size" -- the number of bytes to be written (1, 2, or 4)
 //	"value" -- the data to be written
@@ -164,6 +167,9 @@ Machine::WriteMem(int addr, int size, int value)
 	
       default: ASSERT(FALSE);
     }
+    decodeValid[physicalAddress / 4] = FALSE;	// in case it was code
+    if (blockCovered[physicalAddress / 4])
+	InvalidateDecodeCache(physicalAddress / PageSize);
     
     return TRUE;
 }
@@ -181,6 +187,11 @@ Machine::WriteMem(int addr, int size, int value)
 //	"physAddr" -- the place to store the physical address
 //	"size" -- the amount of memory being read or written
 // 	"writing" -- if TRUE, check the "read-only" bit in the TLB
+//
+//	Most references hit in the translation cache (transCache), which
+//	skips the search below.  A cached translation is used only if the
+//	entry it came from still says the same thing; anything unusual
+//	(a fault, a read-only page, debugging output) takes the slow path.
 //----------------------------------------------------------------------
 
 ExceptionType
@@ -190,24 +201,46 @@ Machine::Translate(int virtAddr, int* physAddr, int size, bool writing)
     unsigned int vpn, offset;
     TranslationEntry *entry;
     unsigned int pageFrame;
-
-    DEBUG('a', "\tTranslate 0x%x, %s: ", virtAddr, writing ? "write" : "read");
+    TransCacheEntry *cached;
 
 // check for alignment errors
     if (((size == 4) && (virtAddr & 0x3)) || ((size == 2) && (virtAddr & 0x1))){
+	DEBUG('a', "\tTranslate 0x%x, %s: ", virtAddr, writing ? "write" : "read");
 	DEBUG('a', "alignment problem at %d, size %d!\n", virtAddr, size);
 	return AddressErrorException;
     }
-    
-    // we must have either a TLB or a page table, but not both!
-    ASSERT(tlb == NULL || pageTable == NULL);	
-    ASSERT(tlb != NULL || pageTable != NULL);	
 
 // calculate the virtual page number, and offset within the page,
 // from the virtual address
     vpn = (unsigned) virtAddr / PageSize;
     offset = (unsigned) virtAddr % PageSize;
+
+// fast path: a cached translation that is still current
+    if (transCacheTable != ((tlb != NULL) ? tlb : pageTable))
+	FlushTranslationCache();		// new page table or TLB
+    cached = &transCache[vpn & (TransCacheSize - 1)];
+    entry = cached->entry;
+    if (entry != NULL && cached->vpn == vpn && entry->valid
+		&& entry->physicalPage == cached->pageFrame
+		&& (unsigned) entry->virtualPage == vpn
+		&& ((tlb != NULL) ? (entry->asid == currentASID)
+				  : (vpn < pageTableSize))
+		&& !(writing && entry->readOnly) && !DebugIsEnabled('a')) {
+	if (tlb != NULL)
+	    stats->numTLBLookups++;
+	entry->use = TRUE;
+	if (writing)
+	    entry->dirty = TRUE;
+	*physAddr = cached->pageFrame * PageSize + offset;
+	return NoException;
+    }
+
+    DEBUG('a', "\tTranslate 0x%x, %s: ", virtAddr, writing ? "write" : "read");
     
+    // we must have either a TLB or a page table, but not both!
+    ASSERT(tlb == NULL || pageTable == NULL);	
+    ASSERT(tlb != NULL || pageTable != NULL);	
+
     if (tlb == NULL) {		// => page table => vpn is index into table
 	if (vpn >= pageTableSize) {
 	    DEBUG('a', "virtual page # %d too large for page table size %d!\n", 
@@ -220,13 +253,16 @@ Machine::Translate(int virtAddr, int* physAddr, int size, bool writing)
 	}
 	entry = &pageTable[vpn];
     } else {
-        for (entry = NULL, i = 0; i < TLBSize; i++)
-    	    if (tlb[i].valid && (tlb[i].virtualPage == vpn)) {
+	stats->numTLBLookups++;
+        for (entry = NULL, i = 0; i < tlbSize; i++)
+    	    if (tlb[i].valid && (tlb[i].virtualPage == vpn)
+				&& (tlb[i].asid == currentASID)) {
 		entry = &tlb[i];			// FOUND!
 		break;
 	    }
 	if (entry == NULL) {				// not found
     	    DEBUG('a', "*** no valid TLB entry found for this virtual page!\n");
+	    stats->numTLBMisses++;
     	    return PageFaultException;		// really, this is a TLB fault,
 						// the page may be in memory,
 						// but not in the TLB
@@ -251,5 +287,11 @@ Machine::Translate(int virtAddr, int* physAddr, int size, bool writing)
     *physAddr = pageFrame * PageSize + offset;
     ASSERT((*physAddr >= 0) && ((*physAddr + size) <= MemorySize));
     DEBUG('a', "phys addr = 0x%x\n", *physAddr);
+
+    if ((unsigned) entry->virtualPage == vpn) {	// remember it for next time
+	cached->vpn = vpn;
+	cached->entry = entry;
+	cached->pageFrame = pageFrame;
+    }
     return NoException;
 }
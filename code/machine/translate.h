@@ -40,6 +40,26 @@ class TranslationEntry {
 			// page is referenced or modified.
     bool dirty;         // This bit is set by the hardware every time the
 			// page is modified.
+    int asid;		// In the TLB, the address space the entry belongs
+			// to; it matches only when machine->currentASID 
+			// is the same.  Not used in page tables.
+};
+
+// The simulator keeps a small direct-mapped cache of recently used
+// translations, so that most memory references don't have to search
+// the TLB or re-check the page table.  An entry only remembers where
+// the translation came from; it is re-validated against the page
+// table or TLB entry on every use, so the kernel is free to change
+// either one without telling the simulator.
+
+#define TransCacheSize	64	// must be a power of two
+
+class TransCacheEntry {
+  public:
+    unsigned int vpn;		// virtual page # this entry is for
+    TranslationEntry *entry;	// the page table or TLB entry it came
+				// from, or NULL if unused
+    int pageFrame;		// entry->physicalPage, when it was cached
 };
 
 #endif
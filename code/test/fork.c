@@ -0,0 +1,53 @@
+/* fork.c
+ *	Test program for Fork, and the copy-on-write sharing of memory
+ *	between a process and the copies it forks.
+ *
+ *	The parent forks two children before it writes anything, and
+ *	each child forks a grandchild, so pages are shared by several
+ *	processes, some of them copy-on-write from an earlier Fork.  Each
+ *	process then writes the globals, and checks that it sees its own
+ *	values and no one else's.  Every process should exit with status
+ *	0; the last grandchild's procedure just returns, which exits too.
+ *
+ *	No strings: coff2noff can't take both .data and .rdata.
+ */
+
+#include "syscall.h"
+
+int counter = 1;		/* initialized data */
+int other = 2;
+int scratch[64];		/* uninitialized data */
+
+void
+returns()
+{
+    scratch[1] = 7;		/* falls off the end; should exit(0) */
+}
+
+void
+grandchild()
+{
+    other = 30;			/* first write since two Forks */
+    counter = 300;
+    Exit(((counter == 300) && (other == 30) && (scratch[0] == 0)) ? 0 : 1);
+}
+
+void
+child()
+{
+    Fork(grandchild);
+    counter = 100;
+    scratch[0] = 5;
+    Fork(returns);
+    Exit(((counter == 100) && (other == 2) && (scratch[0] == 5)) ? 0 : 2);
+}
+
+int
+main()
+{
+    Fork(child);
+    Fork(child);		/* before we have written anything */
+    counter = 10;
+    Yield();
+    Exit(((counter == 10) && (other == 2) && (scratch[0] == 0)) ? 0 : 3);
+}
@@ -0,0 +1,65 @@
+/* iovec.c
+ *	Test program for scatter/gather I/O.
+ *
+ *	Write a file from several buffers with one WriteV, read it back
+ *	with one ReadV into buffers of different sizes, and check that
+ *	the bytes come back in order.  Then check that bad segment lists
+ *	are refused.  The exit status is the number of checks that 
+ *	failed, so it should be 0.
+ */
+
+#include "syscall.h"
+
+/* no initialized data: coff2noff can't take both .data and .rdata */
+char first[9], second[3], third[16];
+char empty[1];
+
+int
+main()
+{
+    IOVec out[4], in[4], bad[2];
+    char *expect = "head of a gathered write.\n\n";
+    OpenFileId file;
+    int i, failed = 0;
+
+    /* gather, including an empty segment */
+    out[0].buffer = expect;	out[0].size = 5;
+    out[1].buffer = empty;	out[1].size = 0;
+    out[2].buffer = expect + 5;	out[2].size = 16;
+    out[3].buffer = expect + 21; out[3].size = 6;
+    Create("iovec.out");
+    file = Open("iovec.out");
+    if (file < 0)
+	Exit(100);
+    if (WriteV(out, 4, file) != 27)
+	failed++;
+    Close(file);
+
+    /* scatter, into more room than the file has */
+    in[0].buffer = first;	in[0].size = 9;
+    in[1].buffer = second;	in[1].size = 3;
+    in[2].buffer = empty;	in[2].size = 0;
+    in[3].buffer = third;	in[3].size = 16;
+    file = Open("iovec.out");
+    if (ReadV(in, 4, file) != 27)
+	failed++;
+    for (i = 0; i < 27; i++)
+	if (((i < 9) ? first[i] : (i < 12) ? second[i - 9] : third[i - 12])
+							!= expect[i])
+	    failed++;
+
+    /* sizes that don't add up, and bad counts, are refused */
+    bad[0].buffer = first;	bad[0].size = 0x7fffffff;
+    bad[1].buffer = second;	bad[1].size = 0x7fffffff;
+    if (ReadV(bad, 2, file) != -1)
+	failed++;
+    if (WriteV(out, -1, file) != -1)
+	failed++;
+    if (WriteV(out, MaxIOVecs + 1, file) != -1)
+	failed++;
+    Close(file);
+
+    /* and the console is a descriptor like any other */
+    WriteV(out, 4, ConsoleOutput);
+    Exit(failed);
+}
@@ -27,7 +27,7 @@ main()
 	buffer[--i] = '\0';
 
 	if( i > 0 ) {
-		newProc = Exec(buffer);
+		newProc = Exec(buffer, (char **) 0);
 		Join(newProc);
 	}
     }
@@ -117,6 +117,7 @@ Close:
 	.globl Fork
 	.ent	Fork
 Fork:
+	la	$5,ThreadReturn	 /* where "func" returns to */
 	addiu $2,$0,SC_Fork
 	syscall
 	j	$31
@@ -130,6 +131,37 @@ Yield:
 	j	$31
 	.end Yield
 
+	.globl ReadV
+	.ent	ReadV
+ReadV:
+	addiu $2,$0,SC_ReadV
+	syscall
+	j	$31
+	.end ReadV
+
+	.globl WriteV
+	.ent	WriteV
+WriteV:
+	addiu $2,$0,SC_WriteV
+	syscall
+	j	$31
+	.end WriteV
+
+	.globl ThreadFork
+	.ent	ThreadFork
+ThreadFork:
+	la	$5,ThreadReturn	 /* where "func" returns to */
+	addiu $2,$0,SC_ThreadFork
+	syscall
+	j	$31
+	.end ThreadFork
+
+	.ent	ThreadReturn
+ThreadReturn:
+	move	$4,$0
+	jal	Exit	 /* if "func" returns, exit(0) */
+	.end ThreadReturn
+
 /* dummy function to keep gcc happy */
         .globl  __main
         .ent    __main
@@ -0,0 +1,235 @@
+// heap.cc
+//
+//     	Routines to manage a priority queue of "things", kept as a
+//	binary heap in an array: the children of elements[i] are
+//	elements[2i+1] and elements[2i+2], and no element is smaller
+//	than its parent.
+//
+//     	NOTE: Mutual exclusion must be provided by the caller.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "heap.h"
+
+//----------------------------------------------------------------------
+// Heap::Heap
+//	Initialize a heap, empty to start with.
+//
+//	"initialSize" is how many items fit before the array must grow.
+//----------------------------------------------------------------------
+
+Heap::Heap(int initialSize)
+{
+    ASSERT(initialSize > 0);
+    maxElements = initialSize;
+    elements = new HeapElement[maxElements];
+    numElements = 0;
+    nextOrder = 0;
+}
+
+//----------------------------------------------------------------------
+// Heap::~Heap
+//	De-allocate the heap.  As with List, the items themselves are
+//	*not* de-allocated.
+//----------------------------------------------------------------------
+
+Heap::~Heap()
+{
+    delete [] elements;
+}
+
+//----------------------------------------------------------------------
+// Heap::Before
+//	Return TRUE if elements[i] should come out of the heap before
+//	elements[j]: it has a smaller key, or the same key and was put
+//	in earlier.  (Keys are compared allowing for wrap-around.)
+//----------------------------------------------------------------------
+
+bool
+Heap::Before(int i, int j)
+{
+    if (elements[i].key != elements[j].key)
+	return ((int) ((unsigned int) elements[i].key
+			- (unsigned int) elements[j].key) < 0);
+    return ((int) (elements[i].order - elements[j].order) < 0);
+}
+
+//----------------------------------------------------------------------
+// Heap::Swap
+//	Exchange two slots of the heap array.
+//----------------------------------------------------------------------
+
+void
+Heap::Swap(int i, int j)
+{
+    HeapElement tmp = elements[i];
+
+    elements[i] = elements[j];
+    elements[j] = tmp;
+}
+
+//----------------------------------------------------------------------
+// Heap::SiftUp
+// Heap::SiftDown
+//	Restore the heap order after elements[i] has been changed, by
+//	moving it up towards the top, or down towards the bottom, until
+//	it is in its place.
+//----------------------------------------------------------------------
+
+void
+Heap::SiftUp(int i)
+{
+    int parent;
+
+    while (i > 0) {
+	parent = (i - 1) / 2;
+	if (!Before(i, parent))
+	    break;
+	Swap(i, parent);
+	i = parent;
+    }
+}
+
+void
+Heap::SiftDown(int i)
+{
+    int child;
+
+    for (; ; i = child) {
+	child = 2 * i + 1;
+	if (child >= numElements)
+	    break;
+	if ((child + 1 < numElements) && Before(child + 1, child))
+	    child++;				// the smaller child
+	if (!Before(child, i))
+	    break;
+	Swap(i, child);
+    }
+}
+
+//----------------------------------------------------------------------
+// Heap::Insert
+//      Insert an item into the heap, so that it comes out after every
+//	item with a smaller or equal key already there.
+//
+//	"item" is the thing to put in the heap, it can be a pointer to
+//		anything.
+//	"sortKey" is the priority of the item.
+//----------------------------------------------------------------------
+
+void
+Heap::Insert(void *item, int sortKey)
+{
+    int i;
+
+    if (numElements == maxElements) {		// full; double the array
+	HeapElement *bigger = new HeapElement[maxElements * 2];
+
+	for (i = 0; i < numElements; i++)
+	    bigger[i] = elements[i];
+	delete [] elements;
+	elements = bigger;
+	maxElements *= 2;
+    }
+
+    i = numElements++;
+    elements[i].key = sortKey;
+    elements[i].order = nextOrder++;
+    elements[i].item = item;
+    SiftUp(i);					// move it up to its place
+}
+
+//----------------------------------------------------------------------
+// Heap::Min
+//      Return the item with the smallest key, without removing it.
+//
+// Returns:
+//	Pointer to the item, NULL if the heap is empty.
+//	Sets *keyPtr to the item's key (if keyPtr is not NULL).
+//----------------------------------------------------------------------
+
+void *
+Heap::Min(int *keyPtr)
+{
+    if (IsEmpty())
+	return NULL;
+    if (keyPtr != NULL)
+	*keyPtr = elements[0].key;
+    return elements[0].item;
+}
+
+//----------------------------------------------------------------------
+// Heap::RemoveMin
+//      Remove the item with the smallest key from the heap.
+//
+// Returns:
+//	Pointer to the removed item, NULL if the heap is empty.
+//	Sets *keyPtr to the item's key (if keyPtr is not NULL).
+//----------------------------------------------------------------------
+
+void *
+Heap::RemoveMin(int *keyPtr)
+{
+    void *item = Min(keyPtr);
+
+    if (item == NULL)
+	return NULL;
+
+    elements[0] = elements[--numElements];	// move the last one to the
+    SiftDown(0);				// top, then down to its place
+    return item;
+}
+
+//----------------------------------------------------------------------
+// Heap::Remove
+//      Remove an item from wherever it is in the heap.  Finding it
+//	takes time proportional to the number of items.
+//
+// Returns:
+//	TRUE if the item was in the heap.
+//
+//	"item" is the thing to take out of the heap.
+//----------------------------------------------------------------------
+
+bool
+Heap::Remove(void *item)
+{
+    int i;
+
+    for (i = 0; i < numElements; i++)
+	if (elements[i].item == item)
+	    break;
+    if (i == numElements)
+	return FALSE;
+
+    elements[i] = elements[--numElements];	// the last one takes its
+    if (i < numElements) {			// slot, and may belong
+	SiftUp(i);				// above or below it
+	SiftDown(i);
+    }
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// Heap::Mapcar
+//	Apply a function to each item in the heap, smallest key first.
+//	Only meant for debugging, so we don't mind sorting a copy.
+//
+//	"func" is the procedure to apply to each item.
+//----------------------------------------------------------------------
+
+void
+Heap::Mapcar(VoidFunctionPtr func)
+{
+    Heap copy(maxElements);
+    int i;
+
+    for (i = 0; i < numElements; i++)
+	copy.elements[i] = elements[i];
+    copy.numElements = numElements;
+    while (!copy.IsEmpty())
+	(*func)((int) copy.RemoveMin(NULL));
+}
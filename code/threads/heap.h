@@ -0,0 +1,78 @@
+// heap.h
+//	Data structures to manage a priority queue, kept as a binary heap.
+//
+//	Like a sorted List, a Heap holds pointers to anything, each with
+//	an integer key, and gives them back smallest key first.  Unlike
+//	a List, inserting and removing take time proportional to the log
+//	of the number of items, not the number of items, and no memory
+//	is allocated per item -- the heap is a single array, which is
+//	doubled in size when it fills up.
+//
+//	Items with equal keys come out in the order they were put in,
+//	just as with List::SortedInsert.
+//
+//	Keys are compared as if on a circle, like clock times: a key is
+//	smaller than another if it is less than 2^31 behind it.  So keys
+//	that only ever go up (times, stride scheduler pass values) may
+//	wrap around, as long as those in the heap are never that far
+//	apart.
+//
+//	NOTE: Mutual exclusion must be provided by the caller.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef HEAP_H
+#define HEAP_H
+
+#include "copyright.h"
+#include "utility.h"
+
+// The following class defines one slot of the heap array.
+
+class HeapElement {
+  public:
+    int key;			// priority; smallest comes out first
+    unsigned int order;		// when it was inserted, to break ties
+    void *item;			// pointer to item in the heap
+};
+
+// The following class defines a "heap" -- a priority queue of items,
+// ordered by increasing key.
+
+class Heap {
+  public:
+    Heap(int initialSize = 16);	// initialize the heap
+    ~Heap();			// de-allocate the heap (but not the items)
+
+    void Insert(void *item, int sortKey);	// Put item into heap
+    void *RemoveMin(int *keyPtr);	// Remove the item with the smallest
+					// key; NULL if empty
+    void *Min(int *keyPtr);		// Same, but leave it in the heap
+
+    bool Remove(void *item);		// Remove an item from wherever it
+					// is; FALSE if it isn't there
+
+    bool IsEmpty() { return (numElements == 0); }
+    int NumInHeap() { return numElements; }
+    void *Item(int i) { return elements[i].item; }
+					// The i'th item, 0 <= i < NumInHeap,
+					// in no particular order
+
+    void Mapcar(VoidFunctionPtr func);	// Apply "func" to every item,
+					// in order (for debugging)
+
+  private:
+    HeapElement *elements;	// the heap; elements[0] is the smallest
+    int numElements;		// how many slots are in use
+    int maxElements;		// how many slots are allocated
+    unsigned int nextOrder;	// stamp for the next item inserted
+
+    bool Before(int i, int j);	// does elements[i] come out before [j]?
+    void Swap(int i, int j);
+    void SiftUp(int i);		// Move elements[i] up, or down, to
+    void SiftDown(int i);	// its place
+};
+
+#endif // HEAP_H
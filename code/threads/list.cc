@@ -127,6 +127,56 @@ List::Remove()
     return SortedRemove(NULL);  // Same as SortedRemove, but ignore the key
 }
 
+//----------------------------------------------------------------------
+// List::Front
+//      Return the "item" on the front of the list, leaving it there.
+//
+// Returns:
+//	Pointer to the item, NULL if nothing on the list.
+//----------------------------------------------------------------------
+
+void *
+List::Front()
+{
+    if (IsEmpty())
+	return NULL;
+    return first->item;
+}
+
+//----------------------------------------------------------------------
+// List::RemoveItem
+//      Remove an "item" from wherever it is in the list, for when it
+//	has to leave a queue early, or be put back in a different place.
+//	Walks the list, so this takes time proportional to its length.
+//
+// Returns:
+//	TRUE if the item was on the list.
+//
+//	"item" is the thing to take off the list.
+//----------------------------------------------------------------------
+
+bool
+List::RemoveItem(void *item)
+{
+    ListElement *element, *prev = NULL;
+
+    for (element = first; element != NULL; element = element->next) {
+	if (element->item == item)
+	    break;
+	prev = element;
+    }
+    if (element == NULL)
+	return FALSE;
+    if (prev == NULL)
+	first = element->next;
+    else
+	prev->next = element->next;
+    if (last == element)
+	last = prev;
+    delete element;
+    return TRUE;
+}
+
 //----------------------------------------------------------------------
 // List::Mapcar
 //	Apply a function to each item on the list, by walking through  
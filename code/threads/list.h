@@ -48,6 +48,9 @@ class List {
     void Prepend(void *item); 	// Put item at the beginning of the list
     void Append(void *item); 	// Put item at the end of the list
     void *Remove(); 	 	// Take item off the front of the list
+    void *Front();		// Look at the front item, without removing it
+    bool RemoveItem(void *item);	// Take item off the list, wherever
+				// it is; FALSE if it isn't there
 
     void Mapcar(VoidFunctionPtr func);	// Apply "func" to every element 
 					// on the list
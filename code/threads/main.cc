@@ -9,7 +9,10 @@
 // 	Most of this file is not needed until later assignments.
 //
 // Usage: nachos -d <debugflags> -rs <random seed #>
-//		-s -x <nachos file> -c <consoleIn> <consoleOut>
+//		-sched <fifo|rr|prio|mlfq|stride|lottery> -q <test #>
+//		-s -b -x <nachos file> -c <consoleIn> <consoleOut>
+//		-rp <fifo|clock|lru|ws> -np <# of frames>
+//		-tlb <# of entries> -tp <random|fifo|lru>
 //		-f -cp <unix file> <nachos file>
 //		-p <nachos file> -r <nachos file> -l -D -t
 //              -n <network reliability> -m <machine id>
@@ -18,13 +21,29 @@
 //
 //    -d causes certain debugging messages to be printed (cf. utility.h)
 //    -rs causes Yield to occur at random (but repeatable) spots
+//    -sched sets the CPU scheduling policy (default fifo, which only
+//	 switches threads with -rs); rr is round robin, prio runs
+//	 threads in order of priority, mlfq is a multilevel feedback
+//	 queue, and stride and lottery share the CPU in proportion to
+//	 each thread's tickets, all preempting on a regular timer
 //    -z prints the copyright message
 //
+//  THREADS
+//    -q runs the given test in threadtest.cc (must come after -sched)
+//
 //  USER_PROGRAM
 //    -s causes user programs to be executed in single-step mode
+//    -b runs user programs a basic block at a time, which is faster
+//	 (ignored with -s or -d m)
 //    -x runs a user program
 //    -c tests the console
 //
+//  VM
+//    -rp sets the page replacement policy (default fifo)
+//    -np limits the number of physical page frames used for paging
+//    -tlb sets the number of TLB entries (with USE_TLB)
+//    -tp sets the TLB replacement policy (default random)
+//
 //  FILESYS
 //    -f causes the physical disk to be formatted
 //    -cp copies a file from UNIX to Nachos
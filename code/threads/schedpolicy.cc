@@ -0,0 +1,432 @@
+// schedpolicy.cc
+//	Routines for each of the scheduling policies: keeping the ready
+//	threads, choosing the next one to run, and deciding when to
+//	preempt the running thread.
+//
+//	FIFO and round robin keep one list.  Priority scheduling sorts
+//	it by priority, keyed by its negation so the highest comes first;
+//	a thread goes behind others of the same priority.
+//
+//	The multilevel feedback queue finds the highest non-empty level
+//	in constant time, from a bitmap of the levels that have threads.
+//	A boost happens while threads may be blocked; rather than find
+//	them all, each thread records the last boost it was given, and
+//	one that has missed a boost is put back at level 0 when it
+//	becomes ready.
+//
+//	Stride scheduling keeps the ready threads in a heap by pass
+//	value; the scheduler charges a thread its stride for every tick
+//	it runs (Scheduler::Charge).  A thread coming back from being
+//	blocked can't have fallen behind the pass value of the last
+//	thread chosen -- otherwise sleeping would bank CPU time, to be
+//	spent all at once later.  Lottery scheduling draws the next
+//	thread by walking all the ready threads, so it takes time
+//	proportional to how many there are.
+//
+//	All of these are called by the scheduler, with interrupts
+//	disabled.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include <strings.h>
+
+#include "copyright.h"
+#include "schedpolicy.h"
+#include "system.h"
+
+//----------------------------------------------------------------------
+// FIFOPolicy::FIFOPolicy
+// 	Initialize the list of ready threads to empty.
+//
+//	"roundRobin" -- if TRUE, the running thread goes to the back of
+//		the list at every timer interrupt
+//----------------------------------------------------------------------
+
+FIFOPolicy::FIFOPolicy(bool roundRobin)
+{
+    readyList = new List;
+    preemptive = roundRobin;
+}
+
+FIFOPolicy::~FIFOPolicy()
+{
+    delete readyList;
+}
+
+//----------------------------------------------------------------------
+// FIFOPolicy::Insert
+// FIFOPolicy::Remove
+// 	Put a ready thread at the back of the list; take the next one to
+//	run off the front.
+//----------------------------------------------------------------------
+
+void
+FIFOPolicy::Insert(Thread *thread)
+{
+    readyList->Append((void *)thread);
+}
+
+Thread *
+FIFOPolicy::Remove()
+{
+    return (Thread *)readyList->Remove();
+}
+
+void
+FIFOPolicy::Print()
+{
+    readyList->Mapcar((VoidFunctionPtr) ThreadPrint);
+}
+
+//----------------------------------------------------------------------
+// PriorityPolicy::PriorityPolicy
+// 	Initialize the list of ready threads to empty.
+//----------------------------------------------------------------------
+
+PriorityPolicy::PriorityPolicy()
+{
+    readyList = new List;
+}
+
+PriorityPolicy::~PriorityPolicy()
+{
+    delete readyList;
+}
+
+//----------------------------------------------------------------------
+// PriorityPolicy::Insert
+// PriorityPolicy::Remove
+// 	Put a ready thread behind every thread of the same priority or
+//	higher; take the most important one.
+//----------------------------------------------------------------------
+
+void
+PriorityPolicy::Insert(Thread *thread)
+{
+    readyList->SortedInsert((void *)thread, -thread->getPriority());
+}
+
+Thread *
+PriorityPolicy::Remove()
+{
+    return (Thread *)readyList->Remove();
+}
+
+void
+PriorityPolicy::Print()
+{
+    readyList->Mapcar((VoidFunctionPtr) ThreadPrint);
+}
+
+//----------------------------------------------------------------------
+// PriorityPolicy::ShouldPreempt
+// 	At a timer interrupt, the running thread should yield if there
+//	is a ready thread of the same priority or higher.  (There can be
+//	a higher one, if an interrupt handler made it ready.)
+//
+//	"running" is the running thread.
+//----------------------------------------------------------------------
+
+bool
+PriorityPolicy::ShouldPreempt(Thread *running)
+{
+    Thread *next = (Thread *)readyList->Front();
+
+    return (next != NULL) && (next->getPriority() >= running->getPriority());
+}
+
+//----------------------------------------------------------------------
+// PriorityPolicy::Preempts
+// 	A thread runs as soon as it is made ready, if its priority is
+//	higher than the running thread's.
+//
+//	"running" is the running thread.
+//----------------------------------------------------------------------
+
+bool
+PriorityPolicy::Preempts(Thread *running)
+{
+    Thread *next = (Thread *)readyList->Front();
+
+    return (next != NULL) && (next->getPriority() > running->getPriority());
+}
+
+//----------------------------------------------------------------------
+// PriorityPolicy::Requeue
+// 	Move a ready thread to its new place in the list, after its
+//	priority changed (see Thread::UpdatePriority).
+//
+//	"thread" is the thread.
+//----------------------------------------------------------------------
+
+void
+PriorityPolicy::Requeue(Thread *thread)
+{
+    if (readyList->RemoveItem((void *)thread))
+	readyList->SortedInsert((void *)thread, -thread->getPriority());
+}
+
+//----------------------------------------------------------------------
+// MLFQPolicy::MLFQPolicy
+// 	Initialize every level to empty.
+//----------------------------------------------------------------------
+
+MLFQPolicy::MLFQPolicy()
+{
+    int i;
+
+    for (i = 0; i < NumLevels; i++)
+	levels[i] = new List;
+    nonEmpty = 0;
+    boostEpoch = 0;
+    lastBoost = 0;
+}
+
+MLFQPolicy::~MLFQPolicy()
+{
+    int i;
+
+    for (i = 0; i < NumLevels; i++)
+	delete levels[i];
+}
+
+//----------------------------------------------------------------------
+// MLFQPolicy::Insert
+// 	Put a ready thread on the list for its level -- level 0, if
+//	there has been a boost since it last ran.
+//
+//	"thread" is the thread.
+//----------------------------------------------------------------------
+
+void
+MLFQPolicy::Insert(Thread *thread)
+{
+    if (thread->boostEpoch != boostEpoch) {
+	thread->level = 0;
+	thread->boostEpoch = boostEpoch;
+    }
+    levels[thread->level]->Append((void *)thread);
+    nonEmpty |= 1 << thread->level;
+}
+
+//----------------------------------------------------------------------
+// MLFQPolicy::Remove
+// 	Take the first thread off the highest non-empty level.
+//----------------------------------------------------------------------
+
+Thread *
+MLFQPolicy::Remove()
+{
+    Thread *thread;
+    int level;
+
+    if (nonEmpty == 0)
+	return NULL;
+    level = ffs(nonEmpty) - 1;		// the highest level with a thread
+    thread = (Thread *)levels[level]->Remove();
+    if (levels[level]->IsEmpty())
+	nonEmpty &= ~(1 << level);
+    return thread;
+}
+
+void
+MLFQPolicy::Print()
+{
+    int i;
+
+    for (i = 0; i < NumLevels; i++) {
+	printf("level %d: ", i);
+	levels[i]->Mapcar((VoidFunctionPtr) ThreadPrint);
+	printf("\n");
+    }
+}
+
+//----------------------------------------------------------------------
+// MLFQPolicy::ShouldPreempt
+// 	At a timer interrupt, the running thread should yield if it has
+//	used up its quantum (and it drops a level), or if a thread at a
+//	higher level is ready.  Its quantum starts over either way, even
+//	if there is no one to yield to.  This is also where the periodic
+//	boost happens.
+//
+//	"running" is the running thread.
+//----------------------------------------------------------------------
+
+bool
+MLFQPolicy::ShouldPreempt(Thread *running)
+{
+    int now = stats->totalTicks;
+
+    if (now - lastBoost >= BoostInterval)
+	Boost();
+    if (now - running->sliceStart >= Quantum(running->level)) {
+	if (running->level < NumLevels - 1)
+	    running->level++;
+	DEBUG('t', "Thread \"%s\" used its quantum, now at level %d\n",
+	      running->getName(), running->level);
+	running->sliceStart = now;
+	return TRUE;
+    }
+    if (nonEmpty & ((1 << running->level) - 1)) {
+	running->sliceStart = now;
+	return TRUE;
+    }
+    return FALSE;
+}
+
+//----------------------------------------------------------------------
+// MLFQPolicy::WillBlock
+// 	A thread that blocks before using up its quantum is interactive,
+//	or doing I/O, so it rises a level.
+//
+//	"thread" is the thread about to block.
+//----------------------------------------------------------------------
+
+void
+MLFQPolicy::WillBlock(Thread *thread)
+{
+    if (thread->level > 0)
+	thread->level--;
+}
+
+//----------------------------------------------------------------------
+// MLFQPolicy::Boost
+// 	Put every thread back at level 0.  Ready threads are moved now,
+//	in order, level by level; blocked ones notice the new boost when
+//	they become ready.
+//----------------------------------------------------------------------
+
+void
+MLFQPolicy::Boost()
+{
+    List *boosted = new List;
+    Thread *thread;
+    int i;
+
+    DEBUG('t', "Boosting every thread to level 0\n");
+    boostEpoch++;
+    lastBoost = stats->totalTicks;
+    for (i = 0; i < NumLevels; i++)
+	while ((thread = (Thread *)levels[i]->Remove()) != NULL) {
+	    thread->level = 0;
+	    thread->boostEpoch = boostEpoch;
+	    boosted->Append((void *)thread);
+	}
+    delete levels[0];
+    levels[0] = boosted;
+    nonEmpty = boosted->IsEmpty() ? 0 : 1;
+    currentThread->level = 0;
+    currentThread->boostEpoch = boostEpoch;
+}
+
+//----------------------------------------------------------------------
+// StridePolicy::StridePolicy
+// 	Initialize the heap of ready threads to empty.
+//----------------------------------------------------------------------
+
+StridePolicy::StridePolicy()
+{
+    readyHeap = new Heap;
+    globalPass = 0;
+}
+
+StridePolicy::~StridePolicy()
+{
+    delete readyHeap;
+}
+
+//----------------------------------------------------------------------
+// StridePolicy::Insert
+// 	Put a ready thread in the heap by its pass value.  A thread that
+//	was blocked (or is new) is moved up to the pass value of the last
+//	thread chosen, so it gets no credit for the time it wasn't ready.
+//
+//	"thread" is the thread.
+//----------------------------------------------------------------------
+
+void
+StridePolicy::Insert(Thread *thread)
+{
+    if ((thread != currentThread) && ((int) (thread->pass - globalPass) < 0))
+	thread->pass = globalPass;
+    readyHeap->Insert((void *)thread, (int) thread->pass);
+}
+
+//----------------------------------------------------------------------
+// StridePolicy::Remove
+// 	Take out the thread with the smallest pass value.
+//----------------------------------------------------------------------
+
+Thread *
+StridePolicy::Remove()
+{
+    Thread *thread = (Thread *)readyHeap->RemoveMin(NULL);
+
+    if (thread != NULL)
+	globalPass = thread->pass;
+    return thread;
+}
+
+void
+StridePolicy::Print()
+{
+    readyHeap->Mapcar((VoidFunctionPtr) ThreadPrint);
+}
+
+//----------------------------------------------------------------------
+// LotteryPolicy::LotteryPolicy
+// 	Initialize the set of ready threads to empty.
+//----------------------------------------------------------------------
+
+LotteryPolicy::LotteryPolicy()
+{
+    readyHeap = new Heap;
+}
+
+LotteryPolicy::~LotteryPolicy()
+{
+    delete readyHeap;
+}
+
+//----------------------------------------------------------------------
+// LotteryPolicy::Insert
+// LotteryPolicy::Remove
+// 	Add a ready thread to the draw; draw a ticket at random, and take
+//	out the thread holding it.  Tickets are counted at every draw,
+//	since a ready thread's tickets may have been changed.
+//----------------------------------------------------------------------
+
+void
+LotteryPolicy::Insert(Thread *thread)
+{
+    readyHeap->Insert((void *)thread, 0);
+}
+
+Thread *
+LotteryPolicy::Remove()
+{
+    Thread *thread;
+    int i, winner, totalTickets = 0;
+
+    for (i = 0; i < readyHeap->NumInHeap(); i++)
+	totalTickets += ((Thread *)readyHeap->Item(i))->tickets;
+    if (totalTickets == 0)
+	return NULL;
+    winner = Random() % totalTickets;	// the winning ticket
+    for (i = 0; ; i++) {
+	thread = (Thread *)readyHeap->Item(i);
+	if (winner < thread->tickets)
+	    break;
+	winner -= thread->tickets;
+    }
+    readyHeap->Remove((void *)thread);
+    return thread;
+}
+
+void
+LotteryPolicy::Print()
+{
+    readyHeap->Mapcar((VoidFunctionPtr) ThreadPrint);
+}
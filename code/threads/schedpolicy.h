@@ -0,0 +1,175 @@
+// schedpolicy.h
+//	Data structures for the policies the scheduler can use to choose
+//	the next thread to run.
+//
+//	The scheduler (scheduler.h) does the dispatching, and keeps the
+//	accounts every policy needs.  A policy just holds the threads
+//	that are ready to run, in whatever order it likes, and says when
+//	the running thread should be preempted.  Each policy is a
+//	subclass of SchedPolicy:
+//
+//	FIFO -- a thread runs until it blocks or yields (or, with -rs,
+//		until a timer interrupt at some random time)
+//	round robin -- the same, but preempted every TimerTicks
+//	priority -- the highest priority runs, as soon as it is ready;
+//		round robin among threads of the same priority
+//	MLFQ -- multilevel feedback queue.  A thread that runs out its
+//		quantum drops a level (where the quantum is twice as
+//		long), a thread that blocks before then rises a level,
+//		and every so often every thread is put back at the top,
+//		so none of them starves
+//	stride -- each thread gets a share of the CPU in proportion to
+//		its tickets; the one with the smallest pass value (the
+//		CPU time it has used, times the inverse of its tickets)
+//		runs next
+//	lottery -- the same shares, but only on average: each quantum
+//		goes to the holder of a ticket drawn at random
+//
+//	Every routine is called with interrupts disabled.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef SCHEDPOLICY_H
+#define SCHEDPOLICY_H
+
+#include "copyright.h"
+#include "list.h"
+#include "heap.h"
+#include "thread.h"
+#include "stats.h"
+
+// Which policy to use; chosen with "-sched".
+
+enum SchedulerPolicy { FIFOScheduling, RoundRobin, PriorityScheduling,
+		       MultiLevelFeedback, StrideScheduling,
+		       LotteryScheduling };
+
+#define NumLevels	4		// MLFQ priority levels; 0 is the highest
+#define BaseQuantum	TimerTicks	// quantum at level 0; it doubles
+					// at each level below
+#define BoostInterval	(50 * TimerTicks)	// how often every thread is
+					// put back at level 0
+
+// The following class defines the interface every policy provides.
+// By default, a policy is preemptive, preempting the running thread
+// at every timer interrupt.
+
+class SchedPolicy {
+  public:
+    virtual ~SchedPolicy() {}
+
+    virtual void Insert(Thread *thread) = 0;	// Thread is ready to run
+    virtual Thread *Remove() = 0;	// Take out the thread to run next;
+					// NULL if there are none
+    virtual void Print() = 0;		// Print the ready threads
+
+    virtual bool NeedsTimer() { return TRUE; }
+					// Preempt on a regular timer?
+    virtual bool ShouldPreempt(Thread *running) { return TRUE; }
+					// At a timer interrupt, should
+					// the running thread yield?
+    virtual bool Preempts(Thread *running) { return FALSE; }
+					// Should a thread just made ready
+					// take the CPU at once?
+    virtual void WillBlock(Thread *thread) {}
+					// Thread is about to block
+    virtual void Requeue(Thread *thread) {}
+					// A ready thread's priority changed
+};
+
+// First-come first-served; with "preemptive", round robin.
+
+class FIFOPolicy : public SchedPolicy {
+  public:
+    FIFOPolicy(bool roundRobin);
+    ~FIFOPolicy();
+
+    void Insert(Thread *thread);
+    Thread *Remove();
+    void Print();
+    bool NeedsTimer() { return preemptive; }
+
+  private:
+    List *readyList;			// ready threads, in order of arrival
+    bool preemptive;			// round robin?
+};
+
+// Strict priority, round robin among equals.
+
+class PriorityPolicy : public SchedPolicy {
+  public:
+    PriorityPolicy();
+    ~PriorityPolicy();
+
+    void Insert(Thread *thread);
+    Thread *Remove();
+    void Print();
+    bool ShouldPreempt(Thread *running);
+    bool Preempts(Thread *running);
+    void Requeue(Thread *thread);
+
+  private:
+    List *readyList;			// ready threads, sorted by the
+					// negation of their priority
+};
+
+// Multilevel feedback queue.
+
+class MLFQPolicy : public SchedPolicy {
+  public:
+    MLFQPolicy();
+    ~MLFQPolicy();
+
+    void Insert(Thread *thread);
+    Thread *Remove();
+    void Print();
+    bool ShouldPreempt(Thread *running);
+    void WillBlock(Thread *thread);
+
+  private:
+    List *levels[NumLevels];		// ready threads at each level
+    unsigned int nonEmpty;		// bit i is set if levels[i] isn't
+					// empty
+    int boostEpoch;			// how many boosts there have been
+    int lastBoost;			// when the last one was
+
+    int Quantum(int level) { return BaseQuantum << level; }
+    void Boost();			// Put every thread back at level 0
+};
+
+// Stride scheduling.
+
+class StridePolicy : public SchedPolicy {
+  public:
+    StridePolicy();
+    ~StridePolicy();
+
+    void Insert(Thread *thread);
+    Thread *Remove();
+    void Print();
+
+  private:
+    Heap *readyHeap;			// ready threads, by pass value
+    unsigned int globalPass;		// pass value of the last thread
+					// chosen
+};
+
+// Lottery scheduling.
+
+class LotteryPolicy : public SchedPolicy {
+  public:
+    LotteryPolicy();
+    ~LotteryPolicy();
+
+    void Insert(Thread *thread);
+    Thread *Remove();
+    void Print();
+
+  private:
+    Heap *readyHeap;			// ready threads, in order of arrival
+					// (the draw looks at all of them)
+};
+
+#endif // SCHEDPOLICY_H
@@ -11,8 +11,9 @@
 //	end up calling FindNextToRun(), and that would put us in an 
 //	infinite loop.
 //
-// 	Very simple implementation -- no priorities, straight FIFO.
-//	Might need to be improved in later assignments.
+// 	The choosing is left to the scheduling policy (schedpolicy.cc).
+//	Whatever the policy, each thread's time spent ready and running
+//	is recorded here, and printed when it finishes, under MLFQ.
 //
 // Copyright (c) 1992-1993 The Regents of the University of California.
 // All rights reserved.  See copyright.h for copyright notice and limitation 
@@ -25,11 +26,34 @@
 //----------------------------------------------------------------------
 // Scheduler::Scheduler
 // 	Initialize the list of ready but not running threads to empty.
+//
+//	"which" is how to choose the next thread to run.
 //----------------------------------------------------------------------
 
-Scheduler::Scheduler()
+Scheduler::Scheduler(SchedulerPolicy which)
 { 
-    readyList = new List; 
+    policy = which;
+    switch (policy) {
+      case RoundRobin:
+	readyQueue = new FIFOPolicy(TRUE);
+	break;
+      case PriorityScheduling:
+	readyQueue = new PriorityPolicy();
+	break;
+      case MultiLevelFeedback:
+	readyQueue = new MLFQPolicy();
+	break;
+      case StrideScheduling:
+	readyQueue = new StridePolicy();
+	break;
+      case LotteryScheduling:
+	readyQueue = new LotteryPolicy();
+	break;
+      case FIFOScheduling:
+      default:
+	readyQueue = new FIFOPolicy(FALSE);
+	break;
+    }
 } 
 
 //----------------------------------------------------------------------
@@ -39,7 +63,7 @@ Scheduler::Scheduler()
 
 Scheduler::~Scheduler()
 { 
-    delete readyList; 
+    delete readyQueue; 
 } 
 
 //----------------------------------------------------------------------
@@ -55,8 +79,11 @@ Scheduler::ReadyToRun (Thread *thread)
 {
     DEBUG('t', "Putting thread %s on ready list.\n", thread->getName());
 
+    if (thread == currentThread)	// (it is yielding)
+	Charge(thread);
     thread->setStatus(READY);
-    readyList->Append((void *)thread);
+    thread->readySince = stats->totalTicks;
+    readyQueue->Insert(thread);
 }
 
 //----------------------------------------------------------------------
@@ -70,7 +97,7 @@ Scheduler::ReadyToRun (Thread *thread)
 Thread *
 Scheduler::FindNextToRun ()
 {
-    return (Thread *)readyList->Remove();
+    return readyQueue->Remove();
 }
 
 //----------------------------------------------------------------------
@@ -91,6 +118,7 @@ void
 Scheduler::Run (Thread *nextThread)
 {
     Thread *oldThread = currentThread;
+    int now = stats->totalTicks;
     
 #ifdef USER_PROGRAM			// ignore until running user programs 
     if (currentThread->space != NULL) {	// if this thread is a user program,
@@ -102,6 +130,11 @@ Scheduler::Run (Thread *nextThread)
     oldThread->CheckOverflow();		    // check if the old thread
 					    // had an undetected stack overflow
 
+    nextThread->waitTicks += now - nextThread->readySince;
+    nextThread->runningSince = nextThread->sliceStart = now;
+    nextThread->numDispatches++;
+    stats->numContextSwitches++;
+
     currentThread = nextThread;		    // switch to the next thread
     currentThread->setStatus(RUNNING);      // nextThread is now running
     
@@ -129,8 +162,9 @@ Scheduler::Run (Thread *nextThread)
 #ifdef USER_PROGRAM
     if (currentThread->space != NULL) {		// if there is an address space
         currentThread->RestoreUserState();     // to restore, do it.
-	currentThread->space->RestoreState();
-    }
+	if (!currentThread->space->IsLoaded())	// (unless we only switched
+	    currentThread->space->RestoreState();	// between threads of
+    }						// the same program)
 #endif
 }
 
@@ -143,5 +177,115 @@ void
 Scheduler::Print()
 {
     printf("Ready list contents:\n");
-    readyList->Mapcar((VoidFunctionPtr) ThreadPrint);
+    readyQueue->Print();
+}
+
+//----------------------------------------------------------------------
+// Scheduler::ShouldPreempt
+// 	Called by the timer interrupt handler, with interrupts disabled,
+//	to decide whether the running thread should yield.  Up to the
+//	policy.
+//----------------------------------------------------------------------
+
+bool
+Scheduler::ShouldPreempt()
+{
+    return readyQueue->ShouldPreempt(currentThread);
+}
+
+//----------------------------------------------------------------------
+// Scheduler::WillBlock
+// 	Called when a thread is about to block, so the policy can take
+//	note (under MLFQ, it rises a level).
+//
+//	"thread" is the thread about to block.
+//----------------------------------------------------------------------
+
+void
+Scheduler::WillBlock(Thread *thread)
+{
+    readyQueue->WillBlock(thread);
+}
+
+//----------------------------------------------------------------------
+// Scheduler::ThreadFinished
+// 	Called when a thread finishes.  Under MLFQ, print how long it
+//	ran, and how long it was ready but waiting for the CPU.
+//
+//	"thread" is the thread finishing; must be the current one.
+//----------------------------------------------------------------------
+
+void
+Scheduler::ThreadFinished(Thread *thread)
+{
+    int runTicks = thread->runTicks + stats->totalTicks - thread->runningSince;
+
+    if (policy != MultiLevelFeedback)
+	return;
+    printf("Thread \"%s\": ran %d ticks, waited %d ticks, dispatched %d times,"
+	   " finished at level %d\n", thread->getName(), runTicks,
+	   thread->waitTicks, thread->numDispatches, thread->level);
+}
+
+//----------------------------------------------------------------------
+// Scheduler::Requeue
+// 	Called with interrupts disabled when a ready thread's priority
+//	changes (see Thread::UpdatePriority), so the policy can move it
+//	to its new place, if it cares about priorities.
+//
+//	"thread" is the thread; it is ready.
+//----------------------------------------------------------------------
+
+void
+Scheduler::Requeue(Thread *thread)
+{
+    readyQueue->Requeue(thread);
+}
+
+//----------------------------------------------------------------------
+// Scheduler::PreemptIfNeeded
+// 	Called after a thread may have been made ready (or the current
+//	thread's priority lowered).  If the policy says a ready thread
+//	should take the CPU from the current one at once (under priority
+//	scheduling, one with a higher priority), switch to it.
+//
+//	Does nothing if interrupts are disabled -- the caller may be an
+//	interrupt handler, or may need the rest of what it is doing to
+//	be atomic.  The next timer interrupt will do the switch.
+//----------------------------------------------------------------------
+
+void
+Scheduler::PreemptIfNeeded()
+{
+    IntStatus oldLevel;
+
+    if (interrupt->getLevel() == IntOff)
+	return;
+    oldLevel = interrupt->SetLevel(IntOff);
+    if (readyQueue->Preempts(currentThread))
+	currentThread->Yield();
+    (void) interrupt->SetLevel(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// Scheduler::Charge
+// 	Account for the CPU time the running thread has used since it
+//	was dispatched, or last charged: add it to the thread's run time,
+//	and move its pass value on by its stride for every tick.
+//
+//	Called with interrupts disabled when the thread stops running --
+//	from ReadyToRun when it yields, and from Thread::Sleep when it
+//	blocks, before the CPU can go idle.
+//
+//	"thread" is the running thread.
+//----------------------------------------------------------------------
+
+void
+Scheduler::Charge(Thread *thread)
+{
+    int ticks = stats->totalTicks - thread->runningSince;
+
+    thread->runTicks += ticks;
+    thread->pass += (unsigned int) thread->stride * ticks;
+    thread->runningSince = stats->totalTicks;
 }
@@ -2,6 +2,12 @@
 //	Data structures for the thread dispatcher and scheduler.
 //	Primarily, the list of threads that are ready to run.
 //
+//	Which ready thread runs next, and when the running thread is
+//	preempted, is up to a scheduling policy, chosen at startup (see
+//	schedpolicy.h).  The scheduler does the dispatching, and keeps
+//	the accounts every policy needs: how long each thread has run,
+//	and waited while ready.
+//
 // Copyright (c) 1992-1993 The Regents of the University of California.
 // All rights reserved.  See copyright.h for copyright notice and limitation 
 // of liability and disclaimer of warranty provisions.
@@ -12,6 +18,7 @@
 #include "copyright.h"
 #include "list.h"
 #include "thread.h"
+#include "schedpolicy.h"
 
 // The following class defines the scheduler/dispatcher abstraction -- 
 // the data structures and operations needed to keep track of which 
@@ -19,7 +26,8 @@
 
 class Scheduler {
   public:
-    Scheduler();			// Initialize list of ready threads 
+    Scheduler(SchedulerPolicy which = FIFOScheduling);
+    					// Initialize list of ready threads 
     ~Scheduler();			// De-allocate ready list
 
     void ReadyToRun(Thread* thread);	// Thread can be dispatched.
@@ -27,10 +35,27 @@ class Scheduler {
 					// list, if any, and return thread.
     void Run(Thread* nextThread);	// Cause nextThread to start running
     void Print();			// Print contents of ready list
+    SchedulerPolicy getPolicy() { return policy; }
+    bool NeedsTimer() { return readyQueue->NeedsTimer(); }
+					// Should the timer be started?
+
+    bool ShouldPreempt();		// Called on each timer interrupt;
+					// should the running thread yield?
+    void WillBlock(Thread *thread);	// Thread is about to wait in
+					// Semaphore::P
+    void ThreadFinished(Thread *thread);// Report how long a finishing
+					// thread ran and waited
+    void Requeue(Thread *thread);	// A ready thread's priority changed
+    void PreemptIfNeeded();		// Yield, if a thread that should
+					// run first has been made ready
+    void Charge(Thread *thread);	// Account for the CPU time the
+					// running thread has used
     
   private:
-    List *readyList;  		// queue of threads that are ready to run,
-				// but not running
+    SchedulerPolicy policy;		// which policy
+    SchedPolicy *readyQueue;		// the policy, holding the threads
+					// that are ready to run, but not
+					// running
 };
 
 #endif // SCHEDULER_H
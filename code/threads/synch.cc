@@ -67,8 +67,11 @@ Semaphore::P()
     IntStatus oldLevel = interrupt->SetLevel(IntOff);	// disable interrupts
     
     while (value == 0) { 			// semaphore not available
-	queue->Append((void *)currentThread);	// so go to sleep
-	currentThread->Sleep();
+	queue->SortedInsert((void *)currentThread,	// so go to sleep,
+			    -currentThread->getPriority());	// in order
+	currentThread->waitingIn = this;
+	scheduler->WillBlock(currentThread);	// (blocking may raise its
+	currentThread->Sleep();			// MLFQ level)
     } 
     value--; 					// semaphore available, 
 						// consume its value
@@ -78,7 +81,8 @@ Semaphore::P()
 
 //----------------------------------------------------------------------
 // Semaphore::V
-// 	Increment semaphore value, waking up a waiter if necessary.
+// 	Increment semaphore value, waking up a waiter if necessary --
+//	the one with the highest priority, or the first of those.
 //	As with P(), this operation must be atomic, so we need to disable
 //	interrupts.  Scheduler::ReadyToRun() assumes that threads
 //	are disabled when it is called.
@@ -91,31 +95,83 @@ Semaphore::V()
     IntStatus oldLevel = interrupt->SetLevel(IntOff);
 
     thread = (Thread *)queue->Remove();
-    if (thread != NULL)	   // make thread ready, consuming the V immediately
+    if (thread != NULL) {  // make thread ready, consuming the V immediately
+	thread->waitingIn = NULL;
 	scheduler->ReadyToRun(thread);
+    }
     value++;
     (void) interrupt->SetLevel(oldLevel);
+    scheduler->PreemptIfNeeded();	// it may have higher priority
+}
+
+//----------------------------------------------------------------------
+// Semaphore::Requeue
+// 	Move a waiting thread to its place in the queue, after its
+//	priority changed.  Called with interrupts disabled.
+//
+//	"thread" is the thread, if it is waiting here.
+//----------------------------------------------------------------------
+
+void
+Semaphore::Requeue(Thread *thread)
+{
+    if (queue->RemoveItem((void *)thread))
+	queue->SortedInsert((void *)thread, -thread->getPriority());
 }
 
 Lock::Lock(char* debugName) {
     name = debugName;
-    semaphore = new Semaphore("semLock", 1);
+    queue = new List;
     thread = NULL;
+    nextHeld = NULL;
 }
 Lock::~Lock() {
-    delete semaphore;
+    delete queue;
 }
 void Lock::Acquire() {
-    semaphore->P(); //waiting for the lock to become free
+    IntStatus oldLevel = interrupt->SetLevel(IntOff);
+
+    while (thread != NULL) { //waiting for the lock to become free
+        queue->SortedInsert((void *)currentThread,
+                            -currentThread->getPriority());
+        currentThread->waitingFor = this;
+        thread->UpdatePriority(); //holder inherits our priority
+        scheduler->WillBlock(currentThread);
+        currentThread->Sleep();
+    }
+    currentThread->waitingFor = NULL;
     thread = currentThread;
+    nextHeld = thread->heldLocks; //remember we hold it
+    thread->heldLocks = this;
+    (void) interrupt->SetLevel(oldLevel);
 }
 void Lock::Release() {
+    IntStatus oldLevel;
+    Lock **lockPtr;
+    Thread *waiter;
+
     if(isHeldByCurrentThread()){
+        oldLevel = interrupt->SetLevel(IntOff);
+        for (lockPtr = &thread->heldLocks; *lockPtr != this;
+             lockPtr = &(*lockPtr)->nextHeld)
+            ;
+        *lockPtr = nextHeld;
         thread = NULL;
-        semaphore->V();
+        waiter = (Thread *)queue->Remove(); //wake the most important waiter
+        if (waiter != NULL)
+            scheduler->ReadyToRun(waiter);
+        currentThread->UpdatePriority(); //give back what it lent us
+        (void) interrupt->SetLevel(oldLevel);
+        scheduler->PreemptIfNeeded();
     }
 }
 
+//a waiter's priority changed, so move it to its new place
+void Lock::Requeue(Thread *waiter) {
+    if (queue->RemoveItem((void *)waiter))
+        queue->SortedInsert((void *)waiter, -waiter->getPriority());
+}
+
 bool
 Lock::isHeldByCurrentThread()
 {
@@ -157,7 +213,9 @@ void Condition::Wait(Lock* conditionLock) {
     // Make sure there is a condition lock
     ASSERT(conditionLock->isHeldByCurrentThread());
     sem = new Semaphore("cLock", 0);    // Create sem
-    wQueue->Append(sem);        // Add sem to end of list
+    wQueue->SortedInsert(sem, -currentThread->getPriority());
+                                // Add sem behind waiters of the same
+                                // or higher priority
 
     // Releases condition lock and adds it to current thread
     conditionLock->Release();
@@ -44,11 +44,14 @@ class Semaphore {
     
     void P();	 // these are the only operations on a semaphore
     void V();	 // they are both *atomic*
+
+    void Requeue(Thread *thread);	// A waiter's priority changed
     
   private:
     char* name;        // useful for debugging
     int value;         // semaphore value, always >= 0
-    List *queue;       // threads waiting in P() for the value to be > 0
+    List *queue;       // threads waiting in P() for the value to be > 0,
+		       // highest priority first
 };
 
 // The following class defines a "lock".  A lock can be BUSY or FREE.
@@ -62,6 +65,11 @@ class Semaphore {
 // In addition, by convention, only the thread that acquired the lock
 // may release it.  As with semaphores, you can't read the lock value
 // (because the value might change immediately after you read it).  
+//
+// A thread waiting in Acquire lends its priority to the holder, and
+// through it to whoever holds a lock the holder is waiting for, and so
+// on, so that a low priority holder can't keep a high priority thread
+// waiting behind threads of middling priority.
 
 
 
@@ -79,10 +87,18 @@ class Lock {
                                         // checking in Release, and in
                                         // Condition variable ops below.
 
+    Thread *Holder() { return thread; } // NULL if the lock is FREE
+    Thread *FirstWaiter() { return (Thread *)queue->Front(); }
+                                        // highest priority waiter, if any
+    void Requeue(Thread *waiter);       // A waiter's priority changed
+
+    Lock *nextHeld;                     // next lock held by the holder
+
   private:
     char* name;                         // for debugging
-    Semaphore *semaphore;
-    Thread *thread;
+    List *queue;                        // threads waiting in Acquire,
+                                        // highest priority first
+    Thread *thread;                     // holder
 };
                                                  
 
@@ -7,6 +7,9 @@
 
 #include "copyright.h"
 #include "system.h"
+#ifdef USER_PROGRAM
+#include "procman.h"
+#endif
 
 // This defines *all* of the global data structures used by Nachos.
 // These are all initialized and de-allocated by this file.
@@ -29,6 +32,24 @@ SynchDisk   *synchDisk;
 
 #ifdef USER_PROGRAM	// requires either FILESYS or FILESYS_STUB
 Machine *machine;	// user program memory and registers
+OpenFileTable *openFileTable;	// files opened by user programs
+SynchConsole *synchConsole;	// created on first use, since the console
+				// keeps Nachos from ever going idle
+ProcMan *processManager;	// the process table
+#endif
+
+#if defined(USER_PROGRAM) && !defined(VM)
+MemoryManager *memoryManager;	// allocator of physical page frames
+TextCache *textCache;		// executables' code, shared read-only
+#endif
+
+#ifdef VM
+FrameTable *frameTable;		// owner of each physical page frame
+BackingStore *backingStore;	// swap file, for pages not in memory
+#endif
+
+#ifdef USE_TLB
+TLBManager *tlbManager;		// kernel side of the TLB
 #endif
 
 #ifdef NETWORK
@@ -60,7 +81,7 @@ extern void Cleanup();
 static void
 TimerInterruptHandler(int dummy)
 {
-    if (interrupt->getStatus() != IdleMode)
+    if ((interrupt->getStatus() != IdleMode) && scheduler->ShouldPreempt())
 	interrupt->YieldOnReturn();
 }
 
@@ -80,13 +101,23 @@ Initialize(int argc, char **argv)
     int argCount;
     char* debugArgs = "";
     bool randomYield = FALSE;
+    SchedulerPolicy schedPolicy = FIFOScheduling;	// CPU scheduling
 
 #ifdef USER_PROGRAM
     bool debugUserProg = FALSE;	// single step user program
+    bool useBlocks = FALSE;	// simulate a basic block at a time
 #endif
 #ifdef FILESYS_NEEDED
     bool format = FALSE;	// format disk
 #endif
+#ifdef VM
+    ReplacementPolicy policy = FIFOReplace;	// page replacement
+    int numFrames = NumPhysPages;		// physical pages to use
+#endif
+#ifdef USE_TLB
+    int tlbSize = TLBSize;			// entries in the TLB
+    TLBPolicy tlbPolicy = RandomTLB;		// TLB replacement
+#endif
 #ifdef NETWORK
     double rely = 1;		// network reliability
     int netname = 0;		// UNIX socket name
@@ -107,15 +138,80 @@ Initialize(int argc, char **argv)
 						// number generator
 	    randomYield = TRUE;
 	    argCount = 2;
+	} else if (!strcmp(*argv, "-sched")) {
+	    ASSERT(argc > 1);
+	    if (!strcmp(*(argv + 1), "fifo"))
+		schedPolicy = FIFOScheduling;
+	    else if (!strcmp(*(argv + 1), "rr"))
+		schedPolicy = RoundRobin;
+	    else if (!strcmp(*(argv + 1), "prio"))
+		schedPolicy = PriorityScheduling;
+	    else if (!strcmp(*(argv + 1), "mlfq"))
+		schedPolicy = MultiLevelFeedback;
+	    else if (!strcmp(*(argv + 1), "stride"))
+		schedPolicy = StrideScheduling;
+	    else if (!strcmp(*(argv + 1), "lottery"))
+		schedPolicy = LotteryScheduling;
+	    else {
+		printf("Unknown scheduling policy %s\n", *(argv + 1));
+		ASSERT(FALSE);
+	    }
+	    argCount = 2;
 	}
 #ifdef USER_PROGRAM
 	if (!strcmp(*argv, "-s"))
 	    debugUserProg = TRUE;
+	else if (!strcmp(*argv, "-b"))
+	    useBlocks = TRUE;
 #endif
 #ifdef FILESYS_NEEDED
 	if (!strcmp(*argv, "-f"))
 	    format = TRUE;
 #endif
+#ifdef VM
+	if (!strcmp(*argv, "-rp")) {
+	    ASSERT(argc > 1);
+	    if (!strcmp(*(argv + 1), "fifo"))
+		policy = FIFOReplace;
+	    else if (!strcmp(*(argv + 1), "clock"))
+		policy = ClockReplace;
+	    else if (!strcmp(*(argv + 1), "lru"))
+		policy = LRUReplace;
+	    else if (!strcmp(*(argv + 1), "ws"))
+		policy = WorkingSetReplace;
+	    else {
+		printf("Unknown replacement policy %s\n", *(argv + 1));
+		ASSERT(FALSE);
+	    }
+	    argCount = 2;
+	} else if (!strcmp(*argv, "-np")) {
+	    ASSERT(argc > 1);
+	    numFrames = atoi(*(argv + 1));
+	    ASSERT((numFrames > 0) && (numFrames <= NumPhysPages));
+	    argCount = 2;
+	}
+#endif
+#ifdef USE_TLB
+	if (!strcmp(*argv, "-tlb")) {
+	    ASSERT(argc > 1);
+	    tlbSize = atoi(*(argv + 1));
+	    ASSERT(tlbSize > 0);
+	    argCount = 2;
+	} else if (!strcmp(*argv, "-tp")) {
+	    ASSERT(argc > 1);
+	    if (!strcmp(*(argv + 1), "random"))
+		tlbPolicy = RandomTLB;
+	    else if (!strcmp(*(argv + 1), "fifo"))
+		tlbPolicy = FIFOTLB;
+	    else if (!strcmp(*(argv + 1), "lru"))
+		tlbPolicy = LRUTLB;
+	    else {
+		printf("Unknown TLB replacement policy %s\n", *(argv + 1));
+		ASSERT(FALSE);
+	    }
+	    argCount = 2;
+	}
+#endif
 #ifdef NETWORK
 	if (!strcmp(*argv, "-l")) {
 	    ASSERT(argc > 1);
@@ -132,11 +228,13 @@ Initialize(int argc, char **argv)
     DebugInit(debugArgs);			// initialize DEBUG messages
     stats = new Statistics();			// collect statistics
     interrupt = new Interrupt;			// start up interrupt handling
-    scheduler = new Scheduler();		// initialize the ready queue
-    if (randomYield)				// start the timer (if needed)
+    scheduler = new Scheduler(schedPolicy);	// initialize the ready queue
+    if (randomYield || scheduler->NeedsTimer())
 	timer = new Timer(TimerInterruptHandler, 0, randomYield);
+    						// start the timer (if needed)
 
     threadToBeDestroyed = NULL;
+    Thread::FillPool(InitialThreadPool);	// (after "stats")
 
     // We didn't explicitly allocate the current thread we are running in.
     // But if it ever tries to give up the CPU, we better have a Thread
@@ -148,7 +246,14 @@ Initialize(int argc, char **argv)
     CallOnUserAbort(Cleanup);			// if user hits ctl-C
     
 #ifdef USER_PROGRAM
-    machine = new Machine(debugUserProg);	// this must come first
+#ifdef USE_TLB
+    machine = new Machine(debugUserProg, useBlocks, tlbSize);
+#else
+    machine = new Machine(debugUserProg, useBlocks);	// this must come first
+#endif
+    openFileTable = new OpenFileTable(MaxSysOpenFiles);
+    synchConsole = NULL;
+    processManager = new ProcMan();
 #endif
 
 #ifdef FILESYS
@@ -159,6 +264,20 @@ Initialize(int argc, char **argv)
     fileSystem = new FileSystem(format);
 #endif
 
+#if defined(USER_PROGRAM) && !defined(VM)
+    memoryManager = new MemoryManager(NumPhysPages);
+    textCache = new TextCache();
+#endif
+
+#ifdef VM
+    frameTable = new FrameTable(numFrames, policy);
+    backingStore = new BackingStore(NumSwapPages);	// needs fileSystem
+#endif
+
+#ifdef USE_TLB
+    tlbManager = new TLBManager(tlbPolicy);
+#endif
+
 #ifdef NETWORK
     postOffice = new PostOffice(netname, rely, 10);
 #endif
@@ -176,7 +295,24 @@ Cleanup()
     delete postOffice;
 #endif
     
+#ifdef USE_TLB
+    delete tlbManager;
+#endif
+
+#ifdef VM
+    delete backingStore;
+    delete frameTable;
+#endif
+
+#if defined(USER_PROGRAM) && !defined(VM)
+    delete textCache;
+    delete memoryManager;
+#endif
+
 #ifdef USER_PROGRAM
+    delete processManager;
+    delete synchConsole;
+    delete openFileTable;
     delete machine;
 #endif
 
@@ -31,7 +31,32 @@ extern Timer *timer;				// the hardware alarm clock
 
 #ifdef USER_PROGRAM
 #include "machine.h"
+#include "filetable.h"
+#include "synchconsole.h"
 extern Machine* machine;	// user program memory and registers
+extern OpenFileTable *openFileTable;	// files opened by user programs
+extern SynchConsole *synchConsole;	// the console, once a user program
+					// has used it
+class ProcMan;
+extern ProcMan *processManager;		// every process, by PID
+#endif
+
+#if defined(USER_PROGRAM) && !defined(VM)
+#include "addrspace.h"
+extern MemoryManager *memoryManager;	// who is using each physical page
+extern TextCache *textCache;		// code shared between processes
+#endif
+
+#ifdef VM
+#include "frametable.h"
+#include "backingstore.h"
+extern FrameTable *frameTable;		// who is using each physical page
+extern BackingStore *backingStore;	// where evicted pages are kept
+#endif
+
+#ifdef USE_TLB
+#include "tlbmanager.h"
+extern TLBManager *tlbManager;		// refills the TLB on a miss
 #endif
 
 #ifdef FILESYS_NEEDED 		// FILESYS or FILESYS_STUB 
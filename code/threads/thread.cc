@@ -24,10 +24,14 @@
 					// execution stack, for detecting 
 					// stack overflows
 
+void *Thread::freeThreads = NULL;
+int *Thread::freeStacks = NULL;
+
 //----------------------------------------------------------------------
 // Thread::Thread
 // 	Initialize a thread control block, so that we can then call
-//	Thread::Fork.
+//	Thread::Fork.  It gets the same CPU share (tickets) as the
+//	thread creating it, so a forked child inherits its parent's.
 //
 //	"threadName" is an arbitrary string, useful for debugging.
 //----------------------------------------------------------------------
@@ -38,8 +42,22 @@ Thread::Thread(char* threadName)
     stackTop = NULL;
     stack = NULL;
     status = JUST_CREATED;
+    level = 0;
+    boostEpoch = 0;
+    sliceStart = readySince = runningSince = stats->totalTicks;
+    waitTicks = runTicks = numDispatches = 0;
+    priority = effectivePriority = NormalPriority;
+    heldLocks = NULL;
+    waitingFor = NULL;
+    waitingIn = NULL;
+    tickets = (currentThread != NULL) ? currentThread->tickets
+				      : DefaultTickets;
+    stride = Stride1 / tickets;
+    pass = 0;
 #ifdef USER_PROGRAM
     space = NULL;
+    pcb = NULL;
+    userStack = -1;
 #endif
 }
 
@@ -61,7 +79,104 @@ Thread::~Thread()
 
     ASSERT(this != currentThread);
     if (stack != NULL)
+	FreeStack(stack);
+}
+
+//----------------------------------------------------------------------
+// Thread::operator new
+// Thread::operator delete
+// 	Allocate the memory for a Thread object, taking it from the pool
+//	if there is one there; free it, putting it in the pool if there
+//	is room.  Counted in the statistics, to show the pool's hit rate.
+//
+//	This doesn't enable interrupts, so it can't be preempted part way.
+//
+//	"size" -- the size of the object
+//	"thread" -- the object
+//----------------------------------------------------------------------
+
+void *
+Thread::operator new(size_t size)
+{
+    void *thread = freeThreads;
+
+    if ((size != sizeof(Thread)) || (thread == NULL)) {
+	stats->numThreadAllocs++;
+	return ::operator new(size);
+    }
+    freeThreads = *(void **) thread;
+    stats->numPooledThreads--;
+    stats->numThreadAllocs++;
+    stats->numThreadPoolHits++;
+    return thread;
+}
+
+void
+Thread::operator delete(void *thread)
+{
+    if (stats->numPooledThreads >= ThreadPoolSize) {
+	::operator delete(thread);
+	return;
+    }
+    *(void **) thread = freeThreads;
+    freeThreads = thread;
+    stats->numPooledThreads++;
+}
+
+//----------------------------------------------------------------------
+// Thread::AllocStack
+// Thread::FreeStack
+// 	Get an execution stack, from the pool if there is one there;
+//	give one back, to the pool if there is room.  Reusing a stack
+//	saves a trip to the host's allocator, and the mprotect calls in
+//	DeallocBoundedArray.
+//
+//	"stack" -- the stack to give back
+//----------------------------------------------------------------------
+
+int *
+Thread::AllocStack()
+{
+    int *stack = freeStacks;
+
+    stats->numStackAllocs++;
+    if (stack == NULL)
+	return (int *) AllocBoundedArray(StackSize * sizeof(int));
+    freeStacks = *(int **) stack;
+    stats->numPooledStacks--;
+    stats->numStackPoolHits++;
+    return stack;
+}
+
+void
+Thread::FreeStack(int *stack)
+{
+    if (stats->numPooledStacks >= ThreadPoolSize) {
 	DeallocBoundedArray((char *) stack, StackSize * sizeof(int));
+	return;
+    }
+    *(int **) stack = freeStacks;
+    freeStacks = stack;
+    stats->numPooledStacks++;
+}
+
+//----------------------------------------------------------------------
+// Thread::FillPool
+// 	Put Thread objects and stacks in the pools ahead of time, so the
+//	first threads created don't have to go to the host for them.
+//
+//	"count" -- how many of each to add
+//----------------------------------------------------------------------
+
+void
+Thread::FillPool(int count)
+{
+    int i;
+
+    for (i = 0; i < count; i++) {
+	operator delete(::operator new(sizeof(Thread)));
+	FreeStack((int *) AllocBoundedArray(StackSize * sizeof(int)));
+    }
 }
 
 //----------------------------------------------------------------------
@@ -96,6 +211,7 @@ Thread::Fork(VoidFunctionPtr func, int arg)
     scheduler->ReadyToRun(this);	// ReadyToRun assumes that interrupts 
 					// are disabled!
     (void) interrupt->SetLevel(oldLevel);
+    scheduler->PreemptIfNeeded();	// (it may have higher priority)
 }    
 
 //----------------------------------------------------------------------
@@ -147,6 +263,7 @@ Thread::Finish ()
     ASSERT(this == currentThread);
     
     DEBUG('t', "Finishing thread \"%s\"\n", getName());
+    scheduler->ThreadFinished(this);
     
     threadToBeDestroyed = currentThread;
     Sleep();					// invokes SWITCH
@@ -157,11 +274,14 @@ Thread::Finish ()
 // Thread::Yield
 // 	Relinquish the CPU if any other thread is ready to run.
 //	If so, put the thread on the end of the ready list, so that
-//	it will eventually be re-scheduled.
+//	it will eventually be re-scheduled.  (The thread goes on the
+//	list before the next one is chosen, so that with priorities,
+//	it doesn't give way to one that should run after it.)
 //
-//	NOTE: returns immediately if no other thread on the ready queue.
-//	Otherwise returns when the thread eventually works its way
-//	to the front of the ready list and gets re-scheduled.
+//	NOTE: returns immediately if no other thread on the ready queue
+//	should run first.  Otherwise returns when the thread eventually
+//	works its way to the front of the ready list and gets
+//	re-scheduled.
 //
 //	NOTE: we disable interrupts, so that looking at the thread
 //	on the front of the ready list, and switching to it, can be done
@@ -181,11 +301,12 @@ Thread::Yield ()
     
     DEBUG('t', "Yielding thread \"%s\"\n", getName());
     
+    scheduler->ReadyToRun(this);
     nextThread = scheduler->FindNextToRun();
-    if (nextThread != NULL) {
-	scheduler->ReadyToRun(this);
+    if (nextThread != this)
 	scheduler->Run(nextThread);
-    }
+    else
+	setStatus(RUNNING);
     (void) interrupt->SetLevel(oldLevel);
 }
 
@@ -219,12 +340,95 @@ Thread::Sleep ()
     DEBUG('t', "Sleeping thread \"%s\"\n", getName());
 
     status = BLOCKED;
+    scheduler->Charge(this);	// (before any idle time)
     while ((nextThread = scheduler->FindNextToRun()) == NULL)
 	interrupt->Idle();	// no one to run, wait for an interrupt
         
     scheduler->Run(nextThread); // returns when we've been signalled
 }
 
+//----------------------------------------------------------------------
+// Thread::setPriority
+// 	Change the thread's base priority.  What it inherits through
+//	locks it holds still counts; if this lowers the priority of the
+//	running thread, a higher priority one may run instead.
+//
+//	"newPriority" -- the new priority; higher runs first
+//----------------------------------------------------------------------
+
+void
+Thread::setPriority(int newPriority)
+{
+    IntStatus oldLevel = interrupt->SetLevel(IntOff);
+
+    priority = newPriority;
+    UpdatePriority();
+    (void) interrupt->SetLevel(oldLevel);
+    scheduler->PreemptIfNeeded();
+}
+
+//----------------------------------------------------------------------
+// Thread::setTickets
+// 	Change the thread's share of the CPU.  Threads it creates from
+//	now on get the same number of tickets.  Its pass value stays as
+//	it is -- the new stride applies to the CPU time it uses from now
+//	on.
+//
+//	"numTickets" -- its share, relative to the other threads'
+//----------------------------------------------------------------------
+
+void
+Thread::setTickets(int numTickets)
+{
+    ASSERT((numTickets > 0) && (numTickets <= Stride1));
+    tickets = numTickets;
+    stride = Stride1 / numTickets;
+}
+
+//----------------------------------------------------------------------
+// Thread::UpdatePriority
+// 	Recompute the effective priority: the base priority, or that of
+//	the most important thread waiting for a lock this one holds,
+//	whichever is higher.
+//
+//	If it changed, move the thread to its new place in whatever queue
+//	it is in.  And if it is waiting for a lock, the holder of that
+//	lock inherits the change, and so on down the chain of holders;
+//	this is how priority inheritance is transitive.
+//
+//	Called with interrupts disabled, whenever a lock the thread holds
+//	gets or loses a waiter, or its priority is set.
+//----------------------------------------------------------------------
+
+void
+Thread::UpdatePriority()
+{
+    int newPriority = priority;
+    Lock *lock;
+    Thread *waiter;
+
+    ASSERT(interrupt->getLevel() == IntOff);
+    for (lock = heldLocks; lock != NULL; lock = lock->nextHeld)
+	if (((waiter = lock->FirstWaiter()) != NULL)
+			&& (waiter->effectivePriority > newPriority))
+	    newPriority = waiter->effectivePriority;
+    if (newPriority == effectivePriority)
+	return;
+
+    DEBUG('t', "Thread \"%s\" priority %d -> %d\n", name,
+	  effectivePriority, newPriority);
+    effectivePriority = newPriority;
+    if (status == READY)
+	scheduler->Requeue(this);
+    if (waitingIn != NULL)
+	waitingIn->Requeue(this);
+    if (waitingFor != NULL) {
+	waitingFor->Requeue(this);
+	if (waitingFor->Holder() != NULL)
+	    waitingFor->Holder()->UpdatePriority();
+    }
+}
+
 //----------------------------------------------------------------------
 // ThreadFinish, InterruptEnable, ThreadPrint
 //	Dummy functions because C++ does not allow a pointer to a member
@@ -252,7 +456,7 @@ void ThreadPrint(int arg){ Thread *t = (Thread *)arg; t->Print(); }
 void
 Thread::StackAllocate (VoidFunctionPtr func, int arg)
 {
-    stack = (int *) AllocBoundedArray(StackSize * sizeof(int));
+    stack = AllocStack();
 
 #ifdef HOST_SNAKE
     // HP stack works from low addresses to high addresses
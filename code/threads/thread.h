@@ -43,8 +43,13 @@
 #ifdef USER_PROGRAM
 #include "machine.h"
 #include "addrspace.h"
+
+class PCB;
 #endif
 
+class Lock;
+class Semaphore;
+
 // CPU register state to be saved on context switch.  
 // The SPARC and MIPS only need 10 registers, but the Snake needs 18.
 // For simplicity, this is just the max over all architectures.
@@ -55,6 +60,24 @@
 // WATCH OUT IF THIS ISN'T BIG ENOUGH!!!!!
 #define StackSize	(4 * 1024)	// in words
 
+// Thread objects and stacks are recycled: when a thread is deleted,
+// they are kept (up to a limit) for the next thread created, rather
+// than given back to the host.  Some are made ahead of time.
+#define ThreadPoolSize	32		// most of each kept for re-use
+#define InitialThreadPool 8		// how many of each are made at startup
+
+// Thread priorities.  Higher numbers run first (with "-sched prio");
+// any int will do.
+#define NormalPriority	0
+
+// CPU shares, for "-sched stride" and "-sched lottery".  A thread's
+// share is its tickets over the total of the threads competing; its
+// stride, how fast its pass value moves while it runs, is inversely
+// proportional.
+#define DefaultTickets	100
+#define Stride1		(1 << 16)	// stride of a one-ticket thread; also
+					// the most tickets a thread can have
+
 
 // Thread state
 enum ThreadStatus { JUST_CREATED, RUNNING, READY, BLOCKED };
@@ -87,6 +110,11 @@ class Thread {
 					// must not be running when delete 
 					// is called
 
+    void *operator new(size_t size);	// Allocate and free Thread objects
+    void operator delete(void *thread);	// from the pool, if possible
+    static void FillPool(int count);	// Make objects and stacks ahead
+					// of time
+
     // basic thread operations
 
     void Fork(VoidFunctionPtr func, int arg); 	// Make thread run (*func)(arg)
@@ -99,9 +127,48 @@ class Thread {
     void CheckOverflow();   			// Check if thread has 
 						// overflowed its stack
     void setStatus(ThreadStatus st) { status = st; }
+    ThreadStatus getStatus() { return status; }
     char* getName() { return (name); }
     void Print() { printf("%s, ", name); }
 
+    // Scheduling information, kept up to date by the scheduler
+
+    int level;				// MLFQ level; 0 is the highest
+    int boostEpoch;			// the last priority boost it got
+    int sliceStart;			// when its current quantum began
+    int readySince;			// when it last became ready
+    int runningSince;			// when it was last dispatched
+    int waitTicks;			// total time ready but not running
+    int runTicks;			// total time running
+    int numDispatches;			// how many times it was dispatched
+
+    // Priority, and what it inherits from threads waiting for locks
+    // it holds (see synch.cc)
+
+    void setPriority(int newPriority);	// Change the base priority
+    int getPriority() { return effectivePriority; }
+    void UpdatePriority();		// Recompute the effective priority,
+					// after it may have changed
+
+    int priority;			// base priority, as set
+    int effectivePriority;		// the highest of that, and the
+					// priority of anything waiting
+					// for a lock it holds
+    Lock *heldLocks;			// locks it holds, linked through
+					// Lock::nextHeld
+    Lock *waitingFor;			// lock it is waiting to acquire
+    Semaphore *waitingIn;		// semaphore it is waiting in
+
+    // Share of the CPU, under proportional share scheduling
+
+    void setTickets(int numTickets);	// Change its share of the CPU
+
+    int tickets;			// its share, relative to others';
+					// a new thread gets its creator's
+    int stride;				// Stride1 / tickets
+    unsigned int pass;			// CPU time used, times stride; the
+					// smallest pass runs next
+
   private:
     // some of the private data for this class is listed above
     
@@ -115,6 +182,13 @@ class Thread {
     					// Allocate a stack for thread.
 					// Used internally by Fork()
 
+    static int *AllocStack();		// Get a stack, from the pool if
+    static void FreeStack(int *stack);	// possible; return one to it
+
+    static void *freeThreads;		// pooled Thread objects, each
+					// linked through its first word
+    static int *freeStacks;		// pooled stacks, likewise
+
 #ifdef USER_PROGRAM
 // A thread running a user program actually has *two* sets of CPU registers -- 
 // one for its state while executing user code, one for its state 
@@ -127,6 +201,10 @@ class Thread {
     void RestoreUserState();		// restore user-level register state
 
     AddrSpace *space;			// User code this thread is running.
+    PCB *pcb;				// The process it belongs to.
+    int userStack;			// Which of the address space's extra
+					// stacks it runs on; -1 if it is the
+					// thread the program started with
 #endif
 };
 
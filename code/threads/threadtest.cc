@@ -80,6 +80,245 @@ ThreadTest1(int n)
 
 }
 
+//----------------------------------------------------------------------
+// ShareTest
+//      Check proportional share scheduling: run with "-sched stride"
+//      or "-sched lottery", then "-q 2".
+//
+//      Fork CPU-bound threads with different numbers of tickets --
+//      each inherits them from this thread, which sets its own before
+//      forking -- let them compete for ShareTestTicks of simulated
+//      time, then compare the share of the CPU each got with the
+//      share it asked for.  Lottery scheduling is only right on
+//      average, so it is allowed more slack.
+//----------------------------------------------------------------------
+
+#define NumShareThreads	3
+#define ShareTestTicks	(1000 * TimerTicks)
+
+static int shareTickets[NumShareThreads] = { 100, 200, 300 };
+static int shareRan[NumShareThreads];	// CPU time each one got
+static int shareEnd;			// when they all stop
+static Semaphore *shareDone;		// V'ed by each as it stops
+
+static void
+ShareThread(int which)
+{
+    while (stats->totalTicks < shareEnd) {	// burn CPU time; each time
+	(void) interrupt->SetLevel(IntOff);	// interrupts go back on,
+	(void) interrupt->SetLevel(IntOn);	// the clock advances
+    }
+    (void) interrupt->SetLevel(IntOff);
+    scheduler->Charge(currentThread);
+    shareRan[which] = currentThread->runTicks;
+    (void) interrupt->SetLevel(IntOn);
+    shareDone->V();
+}
+
+void
+ShareTest()
+{
+    int i, oldTickets, totalTickets = 0, totalRan = 0;
+    int wanted, got, slack;
+    bool passed = TRUE;
+    Thread *t;
+
+    if ((scheduler->getPolicy() != StrideScheduling)
+		&& (scheduler->getPolicy() != LotteryScheduling)) {
+	printf("Share test needs -sched stride or -sched lottery\n");
+	return;
+    }
+    slack = (scheduler->getPolicy() == StrideScheduling) ? 20 : 50;
+					// in tenths of a percent
+
+    shareDone = new Semaphore("share done", 0);
+    shareEnd = stats->totalTicks + ShareTestTicks;
+    oldTickets = currentThread->tickets;
+    for (i = 0; i < NumShareThreads; i++) {
+	currentThread->setTickets(shareTickets[i]);
+	t = new Thread("share thread");		// gets our tickets
+	ASSERT(t->tickets == shareTickets[i]);
+	t->Fork(ShareThread, i);
+	totalTickets += shareTickets[i];
+    }
+    currentThread->setTickets(oldTickets);
+
+    for (i = 0; i < NumShareThreads; i++)
+	shareDone->P();
+    delete shareDone;
+
+    for (i = 0; i < NumShareThreads; i++)
+	totalRan += shareRan[i];
+    for (i = 0; i < NumShareThreads; i++) {
+	wanted = shareTickets[i] * 1000 / totalTickets;
+	got = shareRan[i] * 1000 / totalRan;
+	printf("Thread %d: %d tickets, wanted %d.%d%%, got %d.%d%% (%d ticks)\n",
+	       i, shareTickets[i], wanted / 10, wanted % 10, got / 10, got % 10,
+	       shareRan[i]);
+	if ((got < wanted - slack) || (got > wanted + slack))
+	    passed = FALSE;
+    }
+    printf("Share test %s\n", passed ? "passed" : "FAILED");
+}
+
+//----------------------------------------------------------------------
+// SchedBenchmark
+//      Compare scheduling policies: run "nachos -sched <policy> -q 3"
+//      for each policy, and compare the numbers.
+//
+//      Three sets of synthetic jobs are run, one set after another:
+//      CPU-bound jobs of different lengths, I/O-bound jobs that
+//      compute briefly and then wait for a simulated device, and a mix
+//      of the two.  Every job in a set arrives at once.  For each set
+//      we report throughput (jobs finished per 10000 ticks), mean and
+//      99th percentile turnaround time (arrival to finish), mean
+//      response time (arrival to first run), and the number of context
+//      switches.
+//
+//      The I/O-bound jobs get a higher priority (for -sched prio), as
+//      a system would give its interactive threads.
+//----------------------------------------------------------------------
+
+#define BenchJobs	8		// jobs in each set
+#define BenchCPUTicks	500		// CPU time of the shortest CPU job
+#define BenchIORounds	10		// bursts of an I/O-bound job
+#define BenchBurstTicks	20		// CPU time of each burst
+#define BenchIOTicks	300		// I/O wait after each burst
+
+class BenchJob {
+  public:
+    bool ioBound;
+    int cpuTicks;			// CPU time to use (in each burst,
+					// if I/O-bound)
+    int arrival;			// when it was forked
+    int start;				// when it first ran
+    int finish;				// when it finished
+};
+
+static Semaphore *benchDone;		// V'ed by each job as it finishes
+
+// The CPU time the current thread has used.
+
+static int
+CPUTime()
+{
+    IntStatus oldLevel = interrupt->SetLevel(IntOff);
+    int ticks = currentThread->runTicks
+			+ stats->totalTicks - currentThread->runningSince;
+
+    (void) interrupt->SetLevel(oldLevel);
+    return ticks;
+}
+
+// Use "ticks" of CPU time.
+
+static void
+Compute(int ticks)
+{
+    int until = CPUTime() + ticks;
+
+    while (CPUTime() < until) {		// each time interrupts go back
+	(void) interrupt->SetLevel(IntOff);	// on, the clock advances
+	(void) interrupt->SetLevel(IntOn);
+    }
+}
+
+// Interrupt handler for the end of a simulated I/O.
+
+static void
+BenchIODone(int arg)
+{
+    ((Semaphore *) arg)->V();
+}
+
+static void
+BenchThread(int arg)
+{
+    BenchJob *job = (BenchJob *) arg;
+    Semaphore *io;
+    int i;
+
+    job->start = stats->totalTicks;
+    if (!job->ioBound)
+	Compute(job->cpuTicks);
+    else {
+	io = new Semaphore("bench I/O", 0);
+	for (i = 0; i < BenchIORounds; i++) {
+	    Compute(job->cpuTicks);
+	    interrupt->Schedule(BenchIODone, (int) io, BenchIOTicks, DiskInt);
+	    io->P();
+	}
+	delete io;
+    }
+    job->finish = stats->totalTicks;
+    benchDone->V();
+}
+
+// Run one set of jobs, the first "numCPU" of them CPU-bound, and
+// print how it went.
+
+static void
+BenchRun(char *name, int numCPU)
+{
+    BenchJob jobs[BenchJobs];
+    int turnaround[BenchJobs];
+    int i, j, tmp, first, last, totalTurnaround = 0, totalResponse = 0;
+    int switches = stats->numContextSwitches;
+    Thread *t;
+
+    for (i = 0; i < BenchJobs; i++) {
+	jobs[i].ioBound = (i >= numCPU);
+	jobs[i].cpuTicks = jobs[i].ioBound ? BenchBurstTicks
+					   : (i + 1) * BenchCPUTicks;
+	jobs[i].arrival = stats->totalTicks;
+	t = new Thread(jobs[i].ioBound ? "I/O-bound job" : "CPU-bound job");
+	if (jobs[i].ioBound)
+	    t->setPriority(NormalPriority + 1);
+	t->Fork(BenchThread, (int) &jobs[i]);
+    }
+    for (i = 0; i < BenchJobs; i++)
+	benchDone->P();
+    switches = stats->numContextSwitches - switches;
+
+    first = jobs[0].arrival;
+    last = first;
+    for (i = 0; i < BenchJobs; i++) {
+	turnaround[i] = jobs[i].finish - jobs[i].arrival;
+	totalTurnaround += turnaround[i];
+	totalResponse += jobs[i].start - jobs[i].arrival;
+	if (jobs[i].finish > last)
+	    last = jobs[i].finish;
+    }
+    for (i = 1; i < BenchJobs; i++)		// sort, for the percentile
+	for (j = i; (j > 0) && (turnaround[j - 1] > turnaround[j]); j--) {
+	    tmp = turnaround[j];
+	    turnaround[j] = turnaround[j - 1];
+	    turnaround[j - 1] = tmp;
+	}
+
+    printf("%-6s %10.2f %10d %10d %10d %10d\n", name,
+	   10000.0 * BenchJobs / (last - first), totalTurnaround / BenchJobs,
+	   turnaround[(99 * BenchJobs + 99) / 100 - 1],
+	   totalResponse / BenchJobs, switches);
+}
+
+void
+SchedBenchmark()
+{
+    static char *policyNames[] = { "fifo", "rr", "prio", "mlfq", "stride",
+				   "lottery" };
+
+    benchDone = new Semaphore("bench done", 0);
+    printf("Scheduling policy %s, %d jobs per set\n",
+	   policyNames[scheduler->getPolicy()], BenchJobs);
+    printf("%-6s %10s %10s %10s %10s %10s\n", "set", "throughput",
+	   "turnaround", "p99", "response", "switches");
+    BenchRun("cpu", BenchJobs);
+    BenchRun("io", 0);
+    BenchRun("mixed", BenchJobs / 2);
+    delete benchDone;
+}
+
 //----------------------------------------------------------------------
 // ThreadTest
 //      Invoke a test routine.
@@ -92,6 +331,12 @@ ThreadTest(int n)
     case 1:
         ThreadTest1(n);
         break;
+    case 2:
+        ShareTest();
+        break;
+    case 3:
+        SchedBenchmark();
+        break;
     default:
         printf("No test specified.\n");
         break;
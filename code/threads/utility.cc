@@ -21,7 +21,10 @@
 #endif
 #endif
 
-static char *enableFlags = NULL; // controls which DEBUG messages are printed 
+#ifndef DEBUG_DISABLED
+bool debugFlags[256];		// controls which DEBUG messages are printed;
+				// all FALSE until DebugInit is called
+#endif
 
 //----------------------------------------------------------------------
 // DebugInit
@@ -37,39 +40,33 @@ static char *enableFlags = NULL; // controls which DEBUG messages are printed
 void
 DebugInit(char *flagList)
 {
-    enableFlags = flagList;
-}
-
-//----------------------------------------------------------------------
-// DebugIsEnabled
-//      Return TRUE if DEBUG messages with "flag" are to be printed.
-//----------------------------------------------------------------------
+#ifndef DEBUG_DISABLED
+    bool all = (flagList != NULL) && (strchr(flagList, '+') != NULL);
+    int i;
 
-bool
-DebugIsEnabled(char flag)
-{
-    if (enableFlags != NULL)
-       return (strchr(enableFlags, flag) != 0) 
-		|| (strchr(enableFlags, '+') != 0);
-    else
-      return FALSE;
+    for (i = 0; i < 256; i++)
+	debugFlags[i] = all;
+    if (flagList != NULL)
+	for (; *flagList != '\0'; flagList++)
+	    debugFlags[(unsigned char) *flagList] = TRUE;
+#endif
 }
 
+#ifndef DEBUG_DISABLED
 //----------------------------------------------------------------------
-// DEBUG
-//      Print a debug message, if flag is enabled.  Like printf,
-//	only with an extra argument on the front.
+// DebugPrint
+//      Print a debug message.  Like printf.  Called by DEBUG, once 
+//	it has checked that the message's flag is enabled.
 //----------------------------------------------------------------------
 
 void 
-DEBUG(char flag, char *format, ...)
+DebugPrint(char *format, ...)
 {
-    if (DebugIsEnabled(flag)) {
-	va_list ap;
-	// You will get an unused variable message here -- ignore it.
-	va_start(ap, format);
-	vfprintf(stdout, format, ap);
-	va_end(ap);
-	fflush(stdout);
-    }
+    va_list ap;
+    // You will get an unused variable message here -- ignore it.
+    va_start(ap, format);
+    vfprintf(stdout, format, ap);
+    va_end(ap);
+    fflush(stdout);
 }
+#endif
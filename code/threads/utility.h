@@ -57,13 +57,37 @@ typedef void (*VoidNoArgFunctionPtr)();
 #include "sysdep.h"				
 
 // Interface to debugging routines.
+//
+// DEBUG and DebugIsEnabled are called on every simulated instruction,
+// so they are cheap: the flags given to DebugInit are turned into a 
+// table once, and checked inline, before paying for the call to print
+// the message.  Compiling with -DDEBUG_DISABLED ("make release") 
+// removes them altogether; -d is then accepted but has no effect.
 
 extern void DebugInit(char* flags);	// enable printing debug messages
 
-extern bool DebugIsEnabled(char flag); 	// Is this debug flag enabled?
+#ifdef DEBUG_DISABLED
+
+inline bool DebugIsEnabled(char flag) { return FALSE; }
+
+#define DEBUG(flag, ...)	do { } while (0)
+
+#else
+
+extern bool debugFlags[256];		// debugFlags[c] is TRUE if DEBUG
+					// messages with flag c are printed
+
+inline bool DebugIsEnabled(char flag) 	// Is this debug flag enabled?
+	{ return debugFlags[(unsigned char) flag]; }
+
+extern void DebugPrint(char* format, ...);	// Print debug message
+
+#define DEBUG(flag, ...)	\
+    do { if (DebugIsEnabled(flag)) DebugPrint(__VA_ARGS__); } while (0)
+					// Print debug message if flag 
+					// is enabled
 
-extern void DEBUG (char flag, char* format, ...);  	// Print debug message 
-							// if flag is enabled
+#endif // DEBUG_DISABLED
 
 //----------------------------------------------------------------------
 // ASSERT
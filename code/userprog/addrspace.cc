@@ -18,7 +18,8 @@
 #include "copyright.h"
 #include "system.h"
 #include "addrspace.h"
-#include "noff.h"
+#include "synch.h"
+#include "bitmap.h"
 #ifdef HOST_SPARC
 #include <strings.h>
 #endif
@@ -45,31 +46,63 @@ SwapHeader (NoffHeader *noffH)
 	noffH->uninitData.inFileAddr = WordToHost(noffH->uninitData.inFileAddr);
 }
 
+AddrSpace *AddrSpace::loadedSpace = NULL;
+
 //----------------------------------------------------------------------
 // AddrSpace::AddrSpace
 // 	Create an address space to run a user program.
-//	Load the program from a file "executable", and set everything
+//	Load the program from a file "program", and set everything
 //	up so that we can start executing user instructions.
 //
 //	Assumes that the object code file is in NOFF format.
 //
 //	First, set up the translation from program memory to physical 
-//	memory.  For now, this is really simple (1:1), since we are
-//	only uniprogramming, and we have a single unsegmented page table
+//	memory.  Each virtual page gets whatever physical frame the
+//	memory manager hands out, so several programs can be in memory
+//	at once; we still have a single unsegmented page table.  Then
+//	load the code and data a page at a time, through the page table.
+//
+//	Pages that hold only uninitialized data or stack are not given a
+//	frame until they are first touched; programs often declare big
+//	arrays or stacks that they use only part of.
+//
+//	With virtual memory, nothing is loaded yet: every page starts out
+//	invalid, and is brought in by PageIn the first time it is touched.
+//	The address space then owns "program", and closes it when done.
+//
+//	If the file isn't a NOFF executable, or (without virtual memory)
+//	the program won't fit in the free memory, the address space is
+//	left empty, and IsValid says so; it should just be deleted.
 //
-//	"executable" is the file containing the object code to load into memory
+//	"program" is the file containing the object code to load into memory
 //----------------------------------------------------------------------
 
-AddrSpace::AddrSpace(OpenFile *executable)
+AddrSpace::AddrSpace(OpenFile *program)
 {
     NoffHeader noffH;
     unsigned int i, size;
 
-    executable->ReadAt((char *)&noffH, sizeof(noffH), 0);
-    if ((noffH.noffMagic != NOFFMAGIC) && 
-		(WordToHost(noffH.noffMagic) == NOFFMAGIC))
+    pageTable = NULL;			// until we know we can run it
+    numPages = maxPages = zeroStart = stackBase = 0;
+#ifdef VM
+    executable = program;
+    swapSlot = NULL;
+    touched = NULL;
+    asid = -1;				// with a TLB, assigned when we run
+#else
+    copyOnWrite = NULL;
+    text = NULL;
+#endif
+
+    if ((program->ReadAt((char *)&noffH, sizeof(noffH), 0) 
+						!= (int) sizeof(noffH)) ||
+		((noffH.noffMagic != NOFFMAGIC) && 
+		(WordToHost(noffH.noffMagic) != NOFFMAGIC))) {
+	DEBUG('a', "Not a NOFF executable\n");
+	return;
+    }
+    if (noffH.noffMagic != NOFFMAGIC)
     	SwapHeader(&noffH);
-    ASSERT(noffH.noffMagic == NOFFMAGIC);
 
 // how big is address space?
     size = noffH.code.size + noffH.initData.size + noffH.uninitData.size 
@@ -78,54 +111,293 @@ AddrSpace::AddrSpace(OpenFile *executable)
     numPages = divRoundUp(size, PageSize);
     size = numPages * PageSize;
 
-    ASSERT(numPages <= NumPhysPages);		// check we're not trying
-						// to run anything too big --
-						// at least until we have
-						// virtual memory
+// leave room in the page table for more threads' stacks, above ours
+    stackBase = numPages;
+    maxPages = numPages + MaxUserThreads * UserStackPages;
+    for (i = 0; i < MaxUserThreads; i++)
+	stackInUse[i] = FALSE;
+
+// everything after the code and initialized data is zero to start with
+    if (noffH.initData.size > 0)
+	zeroStart = divRoundUp(max(noffH.code.virtualAddr + noffH.code.size,
+		noffH.initData.virtualAddr + noffH.initData.size), PageSize);
+    else
+	zeroStart = divRoundUp(noffH.code.virtualAddr + noffH.code.size, 
+								PageSize);
 
     DEBUG('a', "Initializing address space, num pages %d, size %d\n", 
 					numPages, size);
-// first, set up the translation 
-    pageTable = new TranslationEntry[numPages];
-    for (i = 0; i < numPages; i++) {
-	pageTable[i].virtualPage = i;	// for now, virtual page # = phys page #
-	pageTable[i].physicalPage = i;
+#ifdef VM
+    noffHeader = noffH;
+    pageTable = new TranslationEntry[maxPages];
+    swapSlot = new int[maxPages];
+    touched = new bool[maxPages];
+    for (i = 0; i < maxPages; i++) {
+	pageTable[i].virtualPage = i;
+	pageTable[i].physicalPage = -1;		// not in memory yet
+	pageTable[i].valid = FALSE;
+	pageTable[i].use = FALSE;
+	pageTable[i].dirty = FALSE;
+	pageTable[i].readOnly = FALSE;
+	swapSlot[i] = -1;			// never written out
+	touched[i] = FALSE;
+    }
+#else
+    unsigned int textStart = 0, textEnd = 0;	// shared code pages
+    int textSize = 0;				// and how many bytes
+
+// the code pages may already be in memory, if someone else is running
+// the same program
+    text = textCache->Acquire(program, &noffH);
+    if (text != NULL) {
+	textStart = text->firstPage;
+	textEnd = textStart + text->numPages;
+	textSize = text->numPages * PageSize;
+    }
+    if (zeroStart - (textEnd - textStart) 
+		> (unsigned) memoryManager->NumFreePages()) {
+	DEBUG('a', "Not enough memory for the program\n");
+	if (text != NULL)		// we can't run anything too big --
+	    textCache->Release(text);	// at least until we have virtual
+	text = NULL;			// memory
+	numPages = zeroStart = 0;
+	return;
+    }
+
+// first, set up the translation; the frames come to us zeroed, which
+// takes care of the uninitialized data and stack that share a page with
+// initialized data.  Pages with nothing but zeroes get no frame yet.
+    pageTable = new TranslationEntry[maxPages];
+    for (i = 0; i < maxPages; i++) {
+	pageTable[i].virtualPage = i;
+	if (i >= zeroStart) {
+	    pageTable[i].physicalPage = -1;	// see ZeroFill
+	    pageTable[i].readOnly = FALSE;
+	    pageTable[i].valid = FALSE;
+	    pageTable[i].use = FALSE;
+	    pageTable[i].dirty = FALSE;
+	    continue;
+	} else if ((i >= textStart) && (i < textEnd)) {
+	    pageTable[i].physicalPage = text->frames[i - textStart];
+	    memoryManager->sharePage(pageTable[i].physicalPage);
+	    pageTable[i].readOnly = TRUE;	// shared code
+	} else {
+	    pageTable[i].physicalPage = memoryManager->getPage();
+	    ASSERT(pageTable[i].physicalPage != -1);	// checked above
+	    pageTable[i].readOnly = FALSE;
+	}
 	pageTable[i].valid = TRUE;
 	pageTable[i].use = FALSE;
 	pageTable[i].dirty = FALSE;
-	pageTable[i].readOnly = FALSE;  // if the code segment was entirely on 
-					// a separate page, we could set its 
-					// pages to be read-only
     }
-    
-// zero out the entire address space, to zero the unitialized data segment 
-// and the stack segment
-    bzero(machine->mainMemory, size);
+    copyOnWrite = new bool[maxPages];
+    for (i = 0; i < maxPages; i++)
+	copyOnWrite[i] = FALSE;
 
-// then, copy in the code and data segments into memory
-    if (noffH.code.size > 0) {
+// then, copy in the code (what isn't shared) and data segments into memory
+    if (noffH.code.size > textSize) {
         DEBUG('a', "Initializing code segment, at 0x%x, size %d\n", 
-			noffH.code.virtualAddr, noffH.code.size);
-        executable->ReadAt(&(machine->mainMemory[noffH.code.virtualAddr]),
-			noffH.code.size, noffH.code.inFileAddr);
+			noffH.code.virtualAddr + textSize, 
+			noffH.code.size - textSize);
+        ReadFile(noffH.code.virtualAddr + textSize, program, 
+			noffH.code.size - textSize, 
+			noffH.code.inFileAddr + textSize);
     }
     if (noffH.initData.size > 0) {
         DEBUG('a', "Initializing data segment, at 0x%x, size %d\n", 
 			noffH.initData.virtualAddr, noffH.initData.size);
-        executable->ReadAt(&(machine->mainMemory[noffH.initData.virtualAddr]),
+        ReadFile(noffH.initData.virtualAddr, program, 
 			noffH.initData.size, noffH.initData.inFileAddr);
     }
+#endif // VM
+}
+
+#ifndef VM
+//----------------------------------------------------------------------
+// AddrSpace::ZeroFill
+// 	Handle a page fault on a page of uninitialized data or stack that
+//	hasn't been touched yet: give it a frame, which comes zeroed.
+//
+//	Returns FALSE if the page is not one of those, ie, the address is
+//	not part of the address space.
+//
+//	"virtualPage" -- the page that faulted
+//----------------------------------------------------------------------
 
+bool
+AddrSpace::ZeroFill(int virtualPage)
+{
+    TranslationEntry *entry;
+
+    if ((virtualPage < (int) zeroStart) || 
+		((unsigned int) virtualPage >= numPages))
+	return FALSE;
+    entry = &pageTable[virtualPage];
+    if (entry->valid)			// (a kernel thread beat us to it)
+	return TRUE;
+
+    entry->physicalPage = memoryManager->getPage();
+    if (entry->physicalPage == -1) {
+	printf("Out of memory for a zero-fill page!\n");
+	ASSERT(FALSE);
+    }
+    stats->numZeroFills++;
+    DEBUG('a', "Zero-filled virtual page %d in frame %d\n", virtualPage,
+						entry->physicalPage);
+    entry->valid = TRUE;
+    return TRUE;
 }
 
+//----------------------------------------------------------------------
+// AddrSpace::AddrSpace
+// 	Create an address space that is a copy of another, for Fork.
+//
+//	Nothing is copied yet: the new page table points at the same
+//	frames as the parent's, and every page is made read-only in both,
+//	and marked copy-on-write.  The first write to such a page, by
+//	either one, raises a ReadOnlyException, and CopyOnWrite gives the
+//	writer a private copy of just that page.  So the cost of a Fork
+//	depends on how many pages get written afterwards, not on the 
+//	size of the address space.
+//
+//	"parent" is the address space to copy (normally, the current one)
+//----------------------------------------------------------------------
+
+AddrSpace::AddrSpace(AddrSpace *parent)
+{
+    unsigned int i;
+
+    numPages = parent->numPages;
+    zeroStart = parent->zeroStart;
+    stackBase = parent->stackBase;
+    maxPages = parent->maxPages;
+    for (i = 0; i < MaxUserThreads; i++)
+	stackInUse[i] = FALSE;		// only the forking thread is copied
+    pageTable = new TranslationEntry[maxPages];
+    copyOnWrite = new bool[maxPages];
+    for (i = 0; i < maxPages; i++) {
+	pageTable[i] = parent->pageTable[i];
+	copyOnWrite[i] = FALSE;
+	if (pageTable[i].valid) {
+	    memoryManager->sharePage(pageTable[i].physicalPage);
+	    copyOnWrite[i] = parent->copyOnWrite[i];	// (it may still be,
+							// from another Fork)
+	    if (!pageTable[i].readOnly)	// (really read-only pages just
+		copyOnWrite[i] = parent->copyOnWrite[i] = TRUE;	// stay so)
+	    pageTable[i].readOnly = parent->pageTable[i].readOnly = TRUE;
+	}
+	pageTable[i].use = pageTable[i].dirty = FALSE;
+    }
+    text = parent->text;
+    if (text != NULL)
+	textCache->Share(text);
+    DEBUG('a', "Forked address space, num pages %d\n", numPages);
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::CopyOnWrite
+// 	Handle a write to a copy-on-write page: give it a frame of its
+//	own, with the same contents, and make it writable.  If no one
+//	else is using the frame any more, there is nothing to copy.
+//
+//	Returns FALSE if the page really is read-only.
+//
+//	"virtualPage" -- the page written to
+//----------------------------------------------------------------------
+
+bool
+AddrSpace::CopyOnWrite(int virtualPage)
+{
+    TranslationEntry *entry;
+    int oldFrame, newFrame;
+
+    if ((virtualPage < 0) || ((unsigned int) virtualPage >= numPages) ||
+		!copyOnWrite[virtualPage])
+	return FALSE;
+    entry = &pageTable[virtualPage];
+    oldFrame = entry->physicalPage;
+
+    if (memoryManager->NumRefs(oldFrame) > 1) {
+	newFrame = memoryManager->getPage();
+	if (newFrame == -1) {
+	    printf("Out of memory for copy-on-write!\n");
+	    ASSERT(FALSE);
+	}
+	bcopy(&(machine->mainMemory[oldFrame * PageSize]), 
+		&(machine->mainMemory[newFrame * PageSize]), PageSize);
+	memoryManager->clearPage(oldFrame);
+	entry->physicalPage = newFrame;
+	stats->numCopyOnWrites++;
+	DEBUG('a', "Copied virtual page %d from frame %d to frame %d\n",
+					virtualPage, oldFrame, newFrame);
+    }
+    entry->readOnly = FALSE;
+    copyOnWrite[virtualPage] = FALSE;
+    return TRUE;
+}
+#endif // VM
+
 //----------------------------------------------------------------------
 // AddrSpace::~AddrSpace
-// 	Dealloate an address space.  Nothing for now!
+// 	Dealloate an address space, giving back the frames it was using.
+//	With virtual memory, also give back its swap slots, and close 
+//	the executable.
 //----------------------------------------------------------------------
 
 AddrSpace::~AddrSpace()
 {
-   delete pageTable;
+    if (loadedSpace == this)
+	loadedSpace = NULL;
+#ifdef VM
+    unsigned int i;
+
+#ifdef USE_TLB
+    tlbManager->Release(this);
+#endif
+    frameTable->lock->Acquire();
+    for (i = 0; i < numPages; i++) {
+	if (pageTable[i].valid)
+	    frameTable->FreeFrame(pageTable[i].physicalPage);
+	if (swapSlot[i] != -1)
+	    backingStore->FreeSlot(swapSlot[i]);
+    }
+    frameTable->lock->Release();
+    CountUntouched();
+    delete [] swapSlot;
+    delete [] touched;
+    delete executable;
+#else
+    unsigned int i;
+
+    CountUntouched();
+    for (i = 0; i < numPages; i++)
+	if (pageTable[i].valid)
+	    memoryManager->clearPage(pageTable[i].physicalPage);
+    if (text != NULL)
+	textCache->Release(text);
+    delete [] copyOnWrite;
+#endif
+    delete [] pageTable;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::CountUntouched
+// 	Called when the address space goes away: add the pages that were
+//	to be zero-filled on demand, but never were, to the statistics.
+//----------------------------------------------------------------------
+
+void
+AddrSpace::CountUntouched()
+{
+    unsigned int i;
+
+    for (i = zeroStart; i < numPages; i++)
+#ifdef VM
+	if (!touched[i])
+#else
+	if (!pageTable[i].valid)
+#endif
+	    stats->numZeroPagesUntouched++;
 }
 
 //----------------------------------------------------------------------
@@ -156,8 +428,8 @@ AddrSpace::InitRegisters()
    // Set the stack register to the end of the address space, where we
    // allocated the stack; but subtract off a bit, to make sure we don't
    // accidentally reference off the end!
-    machine->WriteRegister(StackReg, numPages * PageSize - 16);
-    DEBUG('a', "Initializing stack register to %d\n", numPages * PageSize - 16);
+    machine->WriteRegister(StackReg, stackBase * PageSize - 16);
+    DEBUG('a', "Initializing stack register to %d\n", stackBase * PageSize - 16);
 }
 
 //----------------------------------------------------------------------
@@ -177,40 +449,156 @@ void AddrSpace::SaveState()
 //	this address space can run.
 //
 //      For now, tell the machine where to find the page table.
+//	Nothing in memory has to move, and the instructions the machine
+//	has pre-decoded stay good: they are kept by physical address,
+//	and a frame's are thrown away when it gets new contents.
+//
+//	With a TLB, just switch the machine to our ASID; entries loaded
+//	the last time we ran may still be there.
 //----------------------------------------------------------------------
 
 void AddrSpace::RestoreState() 
 {
+#ifdef USE_TLB
+    tlbManager->Activate(this);
+#else
     machine->pageTable = pageTable;
     machine->pageTableSize = numPages;
+#endif
+    loadedSpace = this;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::AllocateStack
+// 	Find room for the stack of another thread running in this address
+//	space.  The stacks go above the program's own, each UserStackPages
+//	long; the address space is extended to cover a stack the first
+//	time it is used.  Nothing is allocated: the pages are zero-filled
+//	when they are first touched, like the rest of the stack.
+//
+//	Returns the stack #, or -1 if there are MaxUserThreads already.
+//----------------------------------------------------------------------
+
+int
+AddrSpace::AllocateStack()
+{
+    unsigned int end;
+    int stack;
+
+    for (stack = 0; stack < MaxUserThreads; stack++)
+	if (!stackInUse[stack])
+	    break;
+    if (stack == MaxUserThreads)
+	return -1;
+    stackInUse[stack] = TRUE;
+
+    end = stackBase + (stack + 1) * UserStackPages;
+    if (end > numPages) {
+	DEBUG('a', "Growing address space to %d pages for stack %d\n", 
+							end, stack);
+	numPages = end;
+#ifndef USE_TLB
+	if (IsLoaded())
+	    machine->pageTableSize = numPages;
+#endif
+    }
+    return stack;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::StackTop
+// 	Return the initial stack pointer for a thread using a stack from
+//	AllocateStack; as in InitRegisters, a little below the top.
+//
+//	"stack" -- the stack #
+//----------------------------------------------------------------------
+
+int
+AddrSpace::StackTop(int stack)
+{
+    return (stackBase + (stack + 1) * UserStackPages) * PageSize - 16;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::FreeStack
+// 	Give back the pages of a thread's stack, when the thread is done.
+//	The virtual pages stay part of the address space, for the next
+//	thread to use, but start out zero again.
+//
+//	"stack" -- the stack #
+//----------------------------------------------------------------------
+
+void
+AddrSpace::FreeStack(int stack)
+{
+    int i, first = stackBase + stack * UserStackPages;
+
+    ASSERT(stackInUse[stack]);
+    for (i = first; i < first + UserStackPages; i++)
+	FreePage(i);
+    stackInUse[stack] = FALSE;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::FreePage
+// 	Give back whatever a page is using -- its frame, and with virtual
+//	memory, its swap slot -- and make it invalid, so that it will be
+//	zero-filled if it is touched again.
+//
+//	"virtualPage" -- the page; must be zero-fill on demand
+//----------------------------------------------------------------------
+
+void
+AddrSpace::FreePage(int virtualPage)
+{
+    TranslationEntry *entry = &pageTable[virtualPage];
+
+    ASSERT(virtualPage >= (int) zeroStart);
+#ifdef VM
+    frameTable->lock->Acquire();
+    if (entry->valid) {
+#ifdef USE_TLB
+	tlbManager->InvalidatePage(this, virtualPage);
+#endif
+	frameTable->FreeFrame(entry->physicalPage);
+    }
+    if (swapSlot[virtualPage] != -1) {
+	backingStore->FreeSlot(swapSlot[virtualPage]);
+	swapSlot[virtualPage] = -1;
+    }
+    entry->valid = FALSE;
+    frameTable->lock->Release();
+#else
+    if (entry->valid)
+	memoryManager->clearPage(entry->physicalPage);
+    entry->valid = FALSE;
+    entry->readOnly = FALSE;
+    copyOnWrite[virtualPage] = FALSE;
+#endif
+    entry->physicalPage = -1;
+    entry->use = entry->dirty = FALSE;
 }
 
 //----------------------------------------------------------------------
 // AddrSpace::Translate
-//      Converts a virtual address to a physical address. It uses
-//      a page table. First, it checks for alignment errors and then
-//      if everything is ok, it sets the dirty bits in the table
-//      entry and stores the translated physical address in 'physAddr'.
-//      Returns exception if there's an error.
+//      Converts a virtual address to a physical address, using our
+//      page table (which need not be the one the machine is using),
+//      and sets the use bit in the table entry.
+//      Returns the physical address, or -1 if the page isn't valid.
 //
 //      "virtAddr" - the virtual address to translate
-//      "physAddr" - the place to store teh physical address
-//      "size" - the amount of memory being read or written
 //----------------------------------------------------------------------
 
 int AddrSpace::Translate(int virtAddr)
 {
     // Create a physical address
-    int size;
     int physAddr;
-    bool writing;
-    int vpn = (unsigned) virtAddr / PageSize;
+    unsigned int vpn = (unsigned) virtAddr / PageSize;
     int offset = (unsigned) virtAddr % PageSize;
     TranslationEntry *entry;
     unsigned int pageFrame;
 
-    DEBUG('a', "\tTranslate 0x%x, %s: ", virtAddr, writing ?
-                "write" : "read");
+    DEBUG('a', "\tTranslate 0x%x: ", virtAddr);
 
     // Calculate the page number and offset within the page from
     // the virtual address
@@ -228,10 +616,8 @@ int AddrSpace::Translate(int virtAddr)
 
     pageFrame = entry->physicalPage;
 
-    // set the use, dirty bits
+    // set the use bit
     entry->use = TRUE;
-    if (writing)
-        entry->dirty = TRUE;
     physAddr = pageFrame * PageSize + offset;
     DEBUG('a', "translate vpn %d to pfn %d\n", virtAddr, physAddr);
 
@@ -241,70 +627,439 @@ int AddrSpace::Translate(int virtAddr)
 //----------------------------------------------------------------------
 // AddrSpace::ReadFile
 //      Loads the code from a file and data segments into the translated
-//      memory, instead of at position 0.
+//      memory, instead of at position 0.  The virtual pages need not
+//      be in consecutive frames, so the data is read a page at a time,
+//      straight from the file into each frame.  Returns the number of
+//      bytes loaded.
 //
-//      "virtAddr" - the virtual address to translate
-//      "physAddr" - the place to store teh physical address
-//      "size" - the amount of memory being read or written
+//      "virtAddr" - where the data goes in the address space
 //      "file" - file that holds the code
+//      "size" - the amount of memory being read or written
+//      "fileAddr" - where the data is in the file
 //----------------------------------------------------------------------
 
 int
 AddrSpace::ReadFile(int virtAddr, OpenFile* file, int size, int fileAddr)
 {
-    char buff[size];
-    int currSize = file->ReadAt(buff, size, fileAddr);
-    int currSizeCopy = currSize;
-    int copied = 0, newSize = 0, phyAddr;
+    int loaded = 0, chunk, numRead, phyAddr;
 
-    while (currSizeCopy > 0) {
+    while (loaded < size) {
         // convert the virtAddr given into phyAddr
         phyAddr = Translate(virtAddr);
+        ASSERT(phyAddr != -1);
 
-        newSize = min(PageSize, currSizeCopy);
-        bcopy(buff+copied, &machine->mainMemory[phyAddr], newSize);
+        // read up to the end of the page
+        chunk = min(PageSize - (virtAddr % PageSize), size - loaded);
+        numRead = file->ReadAt(&machine->mainMemory[phyAddr], chunk, 
+							fileAddr + loaded);
+        loaded += numRead;
+        if (numRead < chunk)
+            break;			// file is short
+        virtAddr += chunk;
+    }
+    return loaded;
+}
 
-        virtAddr = virtAddr + newSize;
-        currSizeCopy = currSizeCopy - newSize;
-        copied = copied + newSize;
+#ifdef VM
+//----------------------------------------------------------------------
+// AddrSpace::PageIn
+// 	Bring a virtual page into main memory, after a page fault on it.
+//	(With a TLB, the fault may have been only a TLB miss, in which
+//	case the page is already in memory and there is nothing to do.)
+//	A frame is taken from the frame table (perhaps evicting some
+//	other page), and filled from the backing store if the page has
+//	been written out, or else from the executable.
+//
+//	Returns FALSE if the page is not part of the address space.
+//
+//	"virtualPage" -- the page that faulted
+//----------------------------------------------------------------------
+
+bool
+AddrSpace::PageIn(int virtualPage)
+{
+    TranslationEntry *entry;
+    int frame;
+
+    if ((virtualPage < 0) || ((unsigned int) virtualPage >= numPages))
+	return FALSE;
+    entry = &pageTable[virtualPage];
+
+    frameTable->lock->Acquire();
+    if (!entry->valid) {		// (someone may have beaten us to it)
+	stats->numPageFaults++;
+	frame = frameTable->AllocFrame(this, virtualPage);
+	if (swapSlot[virtualPage] != -1)
+	    backingStore->PageIn(swapSlot[virtualPage], frame);
+	else
+	    LoadPage(virtualPage, frame);
+	if (!touched[virtualPage] && (virtualPage >= (int) zeroStart))
+	    stats->numZeroFills++;
+	touched[virtualPage] = TRUE;
+	machine->InvalidateDecodeCache(frame);	// new contents
+
+	DEBUG('a', "Paged in virtual page %d to frame %d\n", 
+					virtualPage, frame);
+	entry->physicalPage = frame;
+	entry->use = FALSE;
+	entry->dirty = FALSE;
+	entry->valid = TRUE;
+    }
+    frameTable->lock->Release();
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::PageOut
+// 	Take a virtual page out of main memory, because the frame table
+//	wants its frame.  If it has been modified since it was brought in,
+//	save it in the backing store first; otherwise the copy it was
+//	loaded from (backing store or executable) is still good.
+//
+//	The page is made invalid before it is written, since the write
+//	may block on the disk, and meanwhile our own threads can run; a
+//	store to the page then would be lost.  Instead, they fault, and
+//	wait in PageIn for frameTable->lock, which the caller holds
+//	until the write is done, and the frame refilled.
+//
+//	"virtualPage" -- the page to evict
+//----------------------------------------------------------------------
+
+void
+AddrSpace::PageOut(int virtualPage)
+{
+    TranslationEntry *entry = &pageTable[virtualPage];
+    int frame = entry->physicalPage;
+
+    ASSERT(frameTable->lock->isHeldByCurrentThread());
+    ASSERT(entry->valid);
+#ifdef USE_TLB
+    tlbManager->InvalidatePage(this, virtualPage);	// gets the dirty bit
+#endif
+    entry->valid = FALSE;
+    entry->physicalPage = -1;
+    if (entry->dirty) {
+	if (swapSlot[virtualPage] == -1) {
+	    swapSlot[virtualPage] = backingStore->AllocSlot();
+	    if (swapSlot[virtualPage] == -1) {
+		printf("Out of swap space!\n");
+		ASSERT(FALSE);
+	    }
+	}
+	backingStore->PageOut(swapSlot[virtualPage], frame);
+	stats->numPageOuts++;
+    }
+}
+
+//----------------------------------------------------------------------
+// LoadSegment
+// 	Copy the part of a NOFF segment that falls in one virtual page
+//	from the executable into memory.
+//
+//	"executable" -- the file holding the segment
+//	"segment" -- which part of the file, and where it goes in the 
+//		address space
+//	"pageStart" -- virtual address of the start of the page
+//	"into" -- where the page is in mainMemory
+//----------------------------------------------------------------------
+
+static void
+LoadSegment(OpenFile *executable, Segment *segment, int pageStart, 
+								char *into)
+{
+    int start = max(segment->virtualAddr, pageStart);
+    int end = min(segment->virtualAddr + segment->size, pageStart + PageSize);
+
+    if (start < end)
+	executable->ReadAt(into + (start - pageStart), end - start,
+			segment->inFileAddr + (start - segment->virtualAddr));
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::LoadPage
+// 	Fill a frame with the initial contents of a virtual page: code
+//	and initialized data from the executable, zeroes everywhere else
+//	(uninitialized data and the stack).
+//
+//	"virtualPage" -- the page being brought in
+//	"frame" -- the physical frame to fill
+//----------------------------------------------------------------------
+
+void
+AddrSpace::LoadPage(int virtualPage, int frame)
+{
+    char *into = &(machine->mainMemory[frame * PageSize]);
+    int pageStart = virtualPage * PageSize;
+
+    bzero(into, PageSize);
+    if (virtualPage >= (int) zeroStart)
+	return;				// nothing to read
+    LoadSegment(executable, &noffHeader.code, pageStart, into);
+    LoadSegment(executable, &noffHeader.initData, pageStart, into);
+}
+#endif // VM
+
+//----------------------------------------------------------------------
+// MemoryManager::MemoryManager
+// 	Initialize the physical memory allocator; to start with, every
+//	frame is free.
+//
+//	"numTotalPages" is the number of physical frames to manage.
+//----------------------------------------------------------------------
+
+MemoryManager::MemoryManager(int numTotalPages)
+{
+    pages = new BitMap(numTotalPages);
+    refCount = new int[numTotalPages];
+    for (int i = 0; i < numTotalPages; i++)
+	refCount[i] = 0;
+    lock = new Lock("Memory Manager");
+}
+
+//----------------------------------------------------------------------
+// MemoryManager::~MemoryManager
+// 	De-allocate the physical memory allocator.
+//----------------------------------------------------------------------
+
+MemoryManager::~MemoryManager()
+{
+    delete pages;
+    delete [] refCount;
+    delete lock;
+}
+
+//----------------------------------------------------------------------
+// MemoryManager::getPage
+// 	Allocate the first free physical frame, and zero it.  Anything the
+//	machine had pre-decoded from the frame's old contents is thrown
+//	away.
+//
+//	Returns the frame number, or -1 if memory is full.
+//----------------------------------------------------------------------
+
+int
+MemoryManager::getPage()
+{
+    int page;
+
+    lock->Acquire();
+    page = pages->Find();
+    if (page != -1)
+	refCount[page] = 1;
+    lock->Release();
+
+    if (page != -1) {
+	bzero(&(machine->mainMemory[page * PageSize]), PageSize);
+	machine->InvalidateDecodeCache(page);
     }
-    return currSize;
+    return page;
+}
+
+//----------------------------------------------------------------------
+// MemoryManager::clearPage
+// 	Drop a reference to a physical frame; it is free once no address
+//	space uses it.
+//
+//	"pageId" is the frame to let go of.
+//----------------------------------------------------------------------
+
+void
+MemoryManager::clearPage(int pageId)
+{
+    lock->Acquire();
+    ASSERT(refCount[pageId] > 0);
+    if (--refCount[pageId] == 0)
+	pages->Clear(pageId);
+    lock->Release();
+}
+
+//----------------------------------------------------------------------
+// MemoryManager::sharePage
+// 	Add a reference to a physical frame that is in use, because 
+//	another address space now maps it too.
+//
+//	"pageId" is the shared frame.
+//----------------------------------------------------------------------
+
+void
+MemoryManager::sharePage(int pageId)
+{
+    lock->Acquire();
+    ASSERT(refCount[pageId] > 0);
+    refCount[pageId]++;
+    lock->Release();
+}
+
+//----------------------------------------------------------------------
+// MemoryManager::NumRefs
+// 	Return how many address spaces map a physical frame.
+//
+//	"pageId" is the frame.
+//----------------------------------------------------------------------
+
+int
+MemoryManager::NumRefs(int pageId)
+{
+    int numRefs;
+
+    lock->Acquire();
+    numRefs = refCount[pageId];
+    lock->Release();
+    return numRefs;
 }
 
 //----------------------------------------------------------------------
-// Memory Manager Implementation
+// MemoryManager::NumFreePages
+// 	Return how many physical frames are free.
 //----------------------------------------------------------------------
 
-/* Constructor */
+int
+MemoryManager::NumFreePages()
+{
+    int numFree;
+
+    lock->Acquire();
+    numFree = pages->NumClear();
+    lock->Release();
+    return numFree;
+}
 
-MemoryManager::MemoryManager(int numTotalPages) {  
-  
-  pages = new BitMap(numpages);
-  lock = new Lock("Memory Manager");
+//----------------------------------------------------------------------
+// TextCache::TextCache
+// 	Initialize the text cache; nothing is cached to start with.
+//----------------------------------------------------------------------
+
+TextCache::TextCache()
+{
+    texts = NULL;
+    lock = new Lock("Text Cache");
 }
 
-/* Destructor */
+//----------------------------------------------------------------------
+// TextCache::~TextCache
+// 	De-allocate the text cache.  Any frames still in it go away
+//	with the memory manager.
+//----------------------------------------------------------------------
+
+TextCache::~TextCache()
+{
+    SharedText *text;
 
-MemoryManager::~MemoryManager() {
-  delete pages;
-  pages = 0;
-  delete lock;  
+    while (texts != NULL) {
+	text = texts;
+	texts = text->next;
+	delete [] text->frames;
+	delete text;
+    }
+    delete lock;
 }
 
-/* Page allocation */
+#ifndef VM
+//----------------------------------------------------------------------
+// TextCache::Acquire
+// 	Return the shared code pages of an executable, loading them if
+//	no one is running it yet.  Executables are told apart by their
+//	file id (see OpenFile::FileId) and length.
+//
+//	Returns NULL if the program has no whole pages of code, or there
+//	isn't enough memory; the caller loads its code privately then.
+//
+//	"executable" -- the program being started
+//	"noffH" -- its header, which says where the code is
+//----------------------------------------------------------------------
+
+SharedText *
+TextCache::Acquire(OpenFile *executable, NoffHeader *noffH)
+{
+    int fileId = executable->FileId();
+    int fileLength = executable->Length();
+    SharedText *text;
+    int i;
+
+    if (((noffH->code.virtualAddr % PageSize) != 0) || 
+		(noffH->code.size < PageSize))
+	return NULL;			// nothing we can share
+
+    lock->Acquire();
+    for (text = texts; text != NULL; text = text->next)
+	if ((text->fileId == fileId) && (text->fileLength == fileLength))
+	    break;
+    if (text != NULL) {
+	DEBUG('a', "Sharing %d code pages of file %d\n", text->numPages, 
+								fileId);
+	text->numUsers++;
+	lock->Release();
+	return text;
+    }
+
+    text = new SharedText;
+    text->fileId = fileId;
+    text->fileLength = fileLength;
+    text->firstPage = noffH->code.virtualAddr / PageSize;
+    text->numPages = noffH->code.size / PageSize;
+    text->frames = new int[text->numPages];
+    for (i = 0; i < text->numPages; i++) {
+	text->frames[i] = memoryManager->getPage();
+	if (text->frames[i] == -1) {		// out of memory; give up
+	    while (--i >= 0)
+		memoryManager->clearPage(text->frames[i]);
+	    delete [] text->frames;
+	    delete text;
+	    lock->Release();
+	    return NULL;
+	}
+	executable->ReadAt(&(machine->mainMemory[text->frames[i] * PageSize]),
+		PageSize, noffH->code.inFileAddr + i * PageSize);
+    }
+    DEBUG('a', "Loaded %d code pages of file %d\n", text->numPages, fileId);
+    text->numUsers = 1;
+    text->next = texts;
+    texts = text;
+    lock->Release();
+    return text;
+}
 
-int MemoryManager::getPage() {
-  lock->Acquire();
-  int page = pages->Find();  
-  lock->Release();
+//----------------------------------------------------------------------
+// TextCache::Share
+// 	Note another user of some shared code, eg, when an address space
+//	using it is forked.
+//----------------------------------------------------------------------
 
-  return page;
+void
+TextCache::Share(SharedText *text)
+{
+    lock->Acquire();
+    ASSERT(text->numUsers > 0);
+    text->numUsers++;
+    lock->Release();
 }
 
-/* Clear page */
+//----------------------------------------------------------------------
+// TextCache::Release
+// 	Note that an address space no longer uses some shared code.  When
+//	the last one is done, take it out of the cache and free its frames.
+//----------------------------------------------------------------------
+
+void
+TextCache::Release(SharedText *text)
+{
+    SharedText **ptr;
+    int i;
+
+    lock->Acquire();
+    ASSERT(text->numUsers > 0);
+    if (--text->numUsers > 0) {
+	lock->Release();
+	return;
+    }
+    for (ptr = &texts; *ptr != text; ptr = &(*ptr)->next)
+	ASSERT(*ptr != NULL);
+    *ptr = text->next;
+    lock->Release();
 
-void MemoryManager::clearPage(int pageId) {
-  lock->Acquire();
-  pages->Clear(physPageNum);
-  lock->Release();
+    for (i = 0; i < text->numPages; i++)
+	memoryManager->clearPage(text->frames[i]);
+    delete [] text->frames;
+    delete text;
 }
+#endif // VM
@@ -15,23 +15,48 @@
 
 #include "copyright.h"
 #include "filesys.h"
-#include “synch.h”
-#include “bitmap.h”
+#include "noff.h"
+
+class Lock;
+class BitMap;
+class SharedText;
 
 #define UserStackSize		1024 	// increase this as necessary!
+#define UserStackPages		divRoundUp(UserStackSize, PageSize)
+#define MaxUserThreads		16	// threads per address space, besides
+					// the one the program starts with
 
 class AddrSpace {
   public:
     AddrSpace(OpenFile *executable);	// Create an address space,
 					// initializing it with the program
 					// stored in the file "executable"
+#ifndef VM
+    AddrSpace(AddrSpace *parent);	// Create a copy of "parent", for
+					// Fork; the pages are shared 
+					// copy-on-write
+#endif
     ~AddrSpace();			// De-allocate an address space
 
+    bool IsValid() { return pageTable != NULL; }
+					// Could the program be loaded?  If
+					// not, nothing else may be called
+
     void InitRegisters();		// Initialize user-level CPU registers,
 					// before jumping to user code
 
     void SaveState();			// Save/restore address space-specific
     void RestoreState();		// info on a context switch 
+    bool IsLoaded() { return this == loadedSpace; }
+					// Is the machine already set up 
+					// for this address space?  (Then
+					// switching to another of its
+					// threads needs no RestoreState.)
+
+    int AllocateStack();		// Find room for another thread's 
+					// stack; returns a stack #, or -1
+    int StackTop(int stack);		// Initial stack pointer for it
+    void FreeStack(int stack);		// Give back its pages
 
     int Translate(int virtAddr);	// Converts virtAddr to physAddr
     int ReadFile(int virtAddr,		// Reads a file and loads the code
@@ -39,30 +64,134 @@ class AddrSpace {
 		              int size,		    // memory
 		              int fileAddr);
 
+#ifndef VM
+    bool ZeroFill(int virtualPage);	// Give a page of uninitialized data
+					// or stack a zeroed frame, the first
+					// time it is touched.  FALSE if it
+					// is not one.
+    bool CopyOnWrite(int virtualPage);	// Give a page its own frame, after
+					// a write to a copy-on-write page.
+					// FALSE if it is not one.
+#endif
+
+#ifdef VM
+    bool PageIn(int virtualPage);	// Bring a page into memory, after
+					// a page fault.  FALSE if it is not
+					// part of the address space.
+    void PageOut(int virtualPage);	// Take a page out of memory, 
+					// saving it first if it is dirty
+    TranslationEntry *PageEntry(int virtualPage)
+			{ return &pageTable[virtualPage]; }
+					// The page's translation, for the
+					// replacement policy to look at
+    int asid;				// tag for our TLB entries, or -1;
+					// managed by tlbManager (USE_TLB)
+#endif
+
   private:
     TranslationEntry *pageTable;	// Assume linear page table translation
 					                        // for now!
     unsigned int numPages;		    // Number of pages in the virtual 
 					// address space
+    unsigned int zeroStart;		// First page that is all uninitialized
+					// data or stack; these pages are
+					// zero-filled on demand
+    unsigned int stackBase;		// First page of the extra threads'
+					// stacks, past the program's own
+    unsigned int maxPages;		// Size of the page table, with room
+					// for every extra stack; "numPages"
+					// grows up to this as they are used
+    bool stackInUse[MaxUserThreads];	// Which extra stacks are taken
+    void FreePage(int virtualPage);	// Give back a page's frame and swap
+					// slot, and make it invalid
+    static AddrSpace *loadedSpace;	// The address space the machine is
+					// set up for, if any
+    void CountUntouched();		// Add the zero-fill pages we never
+					// used to the statistics
+#ifndef VM
+    bool *copyOnWrite;			// for each page, is it shared with
+					// another address space since a
+					// Fork, until someone writes it?
+    SharedText *text;			// our code pages, shared read-only
+					// with every other address space
+					// running the same program; or NULL
+#endif
+#ifdef VM
+    void LoadPage(int virtualPage, int frame);
+					// Fill a frame with a page that has
+					// never been written out
+
+    OpenFile *executable;		// where code and initialized data
+					// are loaded from, on demand
+    NoffHeader noffHeader;		// where they are in the executable
+    int *swapSlot;			// for each page, its slot in the
+					// backing store, or -1 if none
+    bool *touched;			// for each page, has it ever been
+					// brought into memory?
+#endif
 };
 
+// The following class defines the allocator of physical frames, when
+// there is no virtual memory: every page of every address space is
+// given its own frame, for as long as the address space exists.
+
 class MemoryManager {
+  public:
+    MemoryManager(int numTotalPages);	// Initialize; all frames free
+    ~MemoryManager();
+
+    int getPage();			// Allocate the first free frame,
+					// zeroed; -1 if there are none
+    void clearPage(int pageId);		// Drop a reference to a frame, 
+					// freeing it if it was the last
+    void sharePage(int pageId);		// Add a reference to a frame
+    int NumRefs(int pageId);		// How many address spaces use it?
+    int NumFreePages();			// How many frames are free?
 
-public:
-  MemoryManager(int numTotalPages);
+  private:
+    BitMap *pages;			// which frames are in use
+    int *refCount;			// for each frame, how many address
+					// spaces map it (copy-on-write)
+    Lock *lock;				// synchronizes access to "pages"
+};
+
+// The following class defines the code of one executable file, loaded
+// once and mapped read-only into every address space that runs it.
+// Only the pages that hold nothing but code are shared; the last,
+// partial page of code (if any) is loaded privately, along with the
+// data that follows it.
 
-  ~MemoryManager();
+class SharedText {
+  public:
+    int fileId;				// which executable (see OpenFile)
+    int fileLength;			// and how big it is
+    int firstPage;			// virtual page # of the first code page
+    int numPages;			// how many pages are shared
+    int *frames;			// the physical frame of each page
+    int numUsers;			// address spaces mapping it
+    SharedText *next;			// the next one in the text cache
+};
 
-  /* allocates the first clear page */
-  int getPage();
-  
-  /* Takes the index of a page and frees it.*/
-  void clearPage(int pageId);
+// The following class defines the text cache -- every executable's
+// code that is in memory, so that starting another copy of a program
+// doesn't have to read it in again.  A SharedText stays in the cache
+// until the last address space using it goes away.
 
-private:
-  BitMap * pages;  // tracks allocation
-  Lock * lock;
-  
+class TextCache {
+  public:
+    TextCache();			// Initialize; the cache is empty
+    ~TextCache();
+
+    SharedText *Acquire(OpenFile *executable, NoffHeader *noffH);
+					// Find the code of "executable" in 
+					// the cache, or load it; NULL if 
+					// there is nothing to share
+    void Share(SharedText *text);	// Another user of "text" (Fork)
+    void Release(SharedText *text);	// One less user of "text"
+
+  private:
+    SharedText *texts;			// list of cached executables
+    Lock *lock;				// synchronizes access to the cache
 };
 
 #endif // ADDRSPACE_H
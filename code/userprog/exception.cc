@@ -21,12 +21,14 @@
 // All rights reserved.  See copyright.h for copyright notice and limitation 
 // of liability and disclaimer of warranty provisions.
 
+#include <limits.h>
+
 #include "copyright.h"
 #include "system.h"
 #include "syscall.h"
-#include "unistd.h"
 #include "procman.h"
-#include "pcb.h
+#include "pcb.h"
+#include "usermem.h"
 
 //----------------------------------------------------------------------
 // ExceptionHandler
@@ -67,6 +69,16 @@ void AdjustPC()
 void Exit();
 void Join();
 void Yield();
+void Fork();
+void ThreadFork();
+void Exec();
+void Create();
+void Open();
+void Read();
+void Write();
+void Close();
+void ReadV();
+void WriteV();
 
 // Implement dummy function
 
@@ -80,7 +92,7 @@ ExceptionHandler(ExceptionType which)
         {
         case SC_Halt:
             DEBUG('a', "Shutdown, initiated by user program.\n");
-            printf(" System Call: %d invoked Halt", getpid());
+            printf(" System Call: %d invoked Halt", currentThread->pcb->getID());
             interrupt->Halt();
             break;
 
@@ -89,8 +101,7 @@ ExceptionHandler(ExceptionType which)
             break;
 
         case SC_Exec:
-            DEBUG('a', "Exec, initiated by user program.\n");
-            printf(" System Call: %d invoked Exec", getpid());
+            Exec();
             break;
 
         case SC_Join:
@@ -98,44 +109,62 @@ ExceptionHandler(ExceptionType which)
             break;
 
         case SC_Create:
-            DEBUG('a', "Create, initiated by user program.\n");
-            printf(" System Call: %d invoked Create", getpid());
+            Create();
             break;
         
         case SC_Open:
-            DEBUG('a', "Open, initiated by user program.\n");
-            printf(" System Call: %d invoked Open", getpid());
+            Open();
             break;
 
         case SC_Read:
-            DEBUG('a', "Read, initiated by user program.\n");
-            printf(" System Call: %d invoked Read", getpid());
+            Read();
             break;
 
         case SC_Write:
-            DEBUG('a', "Write, initiated by user program.\n");
-            printf(" System Call: %d invoked Write", getpid());
+            Write();
             break;
 
         case SC_Close:
-            DEBUG('a', "Close, initiated by user program.\n");
-            printf(" System Call: %d invoked Close", getpid());
+            Close();
+            break;
+
+        case SC_ReadV:
+            ReadV();
+            break;
+
+        case SC_WriteV:
+            WriteV();
             break;
 
         case SC_Fork:
-            DEBUG('a', "Fork, initiated by user program.\n");
-            printf(" System Call: %d invoked Fork", getpid());
+            Fork();
             break;
 
         case SC_Yield:
-            DEBUG('a', "Yield, initiated by user program.\n");
-            printf(" System Call: %d invoked Yield", getpid());
+            Yield();
+            break;
+
+        case SC_ThreadFork:
+            ThreadFork();
             break;
         
         default:
             printf("Unexpected system call %d\n", type);
             break;
         }
+    } else if ((which == PageFaultException) || 
+					(which == ReadOnlyException)) {
+        int badVAddr = machine->ReadRegister(BadVAddrReg);
+
+        DEBUG('a', "%s at 0x%x\n", (which == PageFaultException) ? 
+			"Page fault" : "Write to read-only page", badVAddr);
+        if (!ResolveFault(which, badVAddr)) {
+            printf("Illegal %s 0x%x in user program\n", 
+		(which == PageFaultException) ? "address" : "write to", 
+		badVAddr);
+            ASSERT(FALSE);
+        }
+        return;		// don't AdjustPC; re-execute the instruction
     } else {
         printf("Unexpected user mode exception %d\n", which);
         ASSERT(FALSE);
@@ -143,43 +172,736 @@ ExceptionHandler(ExceptionType which)
     AdjustPC();
 }
 
+//----------------------------------------------------------------------
+// Exit
+// 	End the current thread, with the exit status in r4.  If it is
+//	the last thread of its process, the process ends too: its memory
+//	and open files are released now, but unless no one can Join it
+//	(its parent is gone), its PCB stays around, as a zombie holding
+//	the exit status, until the parent Joins it or exits.
+//----------------------------------------------------------------------
+
 void Exit(){
+    int status = machine->ReadRegister(4);
+    PCB *pcb = currentThread->pcb;
+    AddrSpace *space = currentThread->space;
 
     DEBUG('a', "Exit, initiated by user program.\n");
-    printf(" System Call: %d invoked Exit", getpid());
+    // Give back our stack while we still count as one of the process's
+    // threads; after that, the last one may exit and delete "space"
+    // while FreeStack waits for the frame table.
+    if (currentThread->userStack != -1) {
+        space->FreeStack(currentThread->userStack);
+        currentThread->userStack = -1;
+    }
+    if (pcb->removeThread() > 0) {	// other threads still running
+        DEBUG('a', "Thread of process %d exits\n", pcb->getID());
+        currentThread->space = NULL;
+        currentThread->pcb = NULL;
+        currentThread->Finish();
+    }
+    printf("Process %d exits with status %d\n", pcb->getID(), status);
 
-    int status = machine->ReadRegister(4);
+    currentThread->space = NULL;	// so Finish won't save user state
+    delete space;
+    pcb->closeAllFiles();
+    currentThread->pcb = NULL;
 
-    printf("Process %d exits with status %d\n",getpid(),&status);
+    processManager->lock->Acquire();
+    pcb->orphanize();			// reaps exited children
+    if (pcb->getParent() == NULL)
+        delete pcb;			// no one will Join it
+    else
+        pcb->setExitStatus(status);	// wakes up the parent's Join
+    processManager->lock->Release();
 
     currentThread->Finish();
 }
-voi Join(){
 
-    DEBUG('a', "Join, initiated by user program.\n");
-    printf(" System Call: %d invoked Join", getpid());
+//----------------------------------------------------------------------
+// Join
+// 	Wait for the child process whose SpaceId is in r4 to exit, and
+//	return its exit status in r2; -1 if it isn't a child of ours.
+//	The child is found by indexing the process table, and we sleep
+//	on its exit condition, so waiting costs nothing.  Joining the 
+//	child reaps it.
+//----------------------------------------------------------------------
 
-    // Read process id from register r4
+void Join(){
     int processId = machine->ReadRegister(4);
-    int processExitId;
+    PCB *pcb = currentThread->pcb;
+    PCB *child;
+    int status = -1;
 
-    // Make sure the requested process id is the child process of the current process
-    /* NEED TO BE IMPLEMENT */
-  
-    //Keep on checking if the requested process is finished. if not, yield the current process
-    /* NEED TO BE IMPLEMENT */
+    DEBUG('a', "Join %d, initiated by user program.\n", processId);
 
-    // If the requested process finished, write the requested process exit id to register r2 to return it.
+    processManager->lock->Acquire();
+    while (((child = pcb->findChild(processId)) != NULL) && 
+						!child->hasExited())
+        child->waitForExit();
+    if (child != NULL) {
+        status = child->getExitStatus();
+        pcb->removeChild(processId);
+        delete child;
+    }
+    processManager->lock->Release();
+
+    machine->WriteRegister(2, status);
+}
 
-    /*save process exit ID into processExitId after PCB is implemented*/
-    /* NEED TO BE IMPLEMENT */
-    machine->WriteRegister(2,processExitId);
+//----------------------------------------------------------------------
+// UserThread
+// 	The first thing a thread created by ThreadFork (or the process
+//	created by Fork) does, in the kernel: start the procedure at the
+//	top of its own stack.  The address space is already the current
+//	one, if the thread that forked us ran last, and then needs no 
+//	RestoreState.
+//
+//	"arg" -- the thread; its registers were set up by ThreadFork
+//		or Fork
+//----------------------------------------------------------------------
 
+static void
+UserThread(int arg)
+{
+    Thread *thread = (Thread *) arg;
+
+    thread->RestoreUserState();
+    if (!thread->space->IsLoaded())
+        thread->space->RestoreState();
+    machine->Run();			// never returns; the thread
+    ASSERT(FALSE);			// ends with Exit
+}
+
+//----------------------------------------------------------------------
+// ThreadFork
+// 	Create a new thread running the procedure whose address is in r4,
+//	in the caller's address space, on a stack of its own.  When the
+//	procedure returns, it goes to the address in r5, which the user
+//	stub sets to code that calls Exit.  Returns 0 in r2, or -1 if the
+//	address space has no room for another stack.
+//----------------------------------------------------------------------
+
+void ThreadFork() {
+    int func = machine->ReadRegister(4);
+    int retAddr = machine->ReadRegister(5);
+    AddrSpace *space = currentThread->space;
+    Thread *thread;
+    int stack, i;
+
+    DEBUG('a', "ThreadFork, initiated by user program.\n");
+    stack = space->AllocateStack();
+    if (stack == -1) {
+        machine->WriteRegister(2, -1);
+        return;
+    }
+    machine->WriteRegister(2, 0);
+
+    thread = new Thread("user thread");
+    thread->space = space;
+    thread->pcb = currentThread->pcb;
+    thread->userStack = stack;
+    thread->pcb->addThread();
+
+    // Set up the registers it will start with, in the machine, and 
+    // save them in the new thread; then put back our own.
+    currentThread->SaveUserState();
+    for (i = 0; i < NumTotalRegs; i++)
+        machine->WriteRegister(i, 0);
+    machine->WriteRegister(PCReg, func);
+    machine->WriteRegister(NextPCReg, func + 4);
+    machine->WriteRegister(RetAddrReg, retAddr);
+    machine->WriteRegister(StackReg, space->StackTop(stack));
+    thread->SaveUserState();
+    currentThread->RestoreUserState();
+
+    thread->Fork(UserThread, (int) thread);
 }
 
-Yield() {
+void Yield() {
     DEBUG('a', "Yield, initiated by user program %s.\n", currentThread->getName());
-    printf("System Call: %d invoked Yield\n", currentThread->space->pcb->GetID());
-   
-    currentThread->Yield; 
+    currentThread->Yield(); 
+}
+
+//----------------------------------------------------------------------
+// Fork
+// 	Create a new process running the procedure whose address is in
+//	r4, in a copy of the caller's address space.  The copy shares the
+//	caller's memory copy-on-write (see AddrSpace::AddrSpace), so 
+//	this is cheap however big the program is.  The procedure starts
+//	at the top of the (copied) stack; as with ThreadFork, if it 
+//	returns, it goes to the address in r5, code that calls Exit.
+//----------------------------------------------------------------------
+
+void Fork() {
+    DEBUG('a', "Fork, initiated by user program.\n");
+
+#ifdef VM
+    printf("Fork is not supported with virtual memory\n");
+#else
+    int func = machine->ReadRegister(4);
+    int retAddr = machine->ReadRegister(5);
+    Thread *child = new Thread("forked process");
+
+    child->space = new AddrSpace(currentThread->space);
+    child->pcb = new PCB(child);
+    child->pcb->setSpace(child->space);
+    child->pcb->inheritFiles(currentThread->pcb);
+    processManager->lock->Acquire();
+    child->pcb->setParent(currentThread->pcb);
+    currentThread->pcb->addChild(child->pcb);
+    processManager->lock->Release();
+
+    // Set up the registers it will start with, as ThreadFork does.
+    currentThread->SaveUserState();
+    child->space->InitRegisters();
+    machine->WriteRegister(PCReg, func);
+    machine->WriteRegister(NextPCReg, func + 4);
+    machine->WriteRegister(RetAddrReg, retAddr);
+    child->SaveUserState();
+    currentThread->RestoreUserState();
+
+    child->Fork(UserThread, (int) child);
+#endif
+}
+
+//----------------------------------------------------------------------
+// ExecArgs
+// 	What Exec hands to the new process: its arguments, copied into
+//	the kernel, and when Exec was called, to time the start-up.
+//----------------------------------------------------------------------
+
+class ExecArgs {
+  public:
+    int argc;			// number of arguments
+    char **argv;		// the arguments, in kernel memory
+    int startTicks;		// stats->totalTicks when Exec was called
+};
+
+//----------------------------------------------------------------------
+// FreeExecArgs
+// 	De-allocate the arguments of an Exec.
+//----------------------------------------------------------------------
+
+static void
+FreeExecArgs(ExecArgs *args)
+{
+    int i;
+
+    for (i = 0; i < args->argc; i++)
+	delete [] args->argv[i];
+    delete [] args->argv;
+    delete args;
+}
+
+//----------------------------------------------------------------------
+// FetchExecArgs
+// 	Copy the null-terminated argument vector of an Exec into the
+//	kernel.  Returns NULL if it is bad, or has more than MaxArgs
+//	arguments, or they won't fit in MaxArgBytes of the new stack,
+//	laid out as in ExecProcess.  (A bigger vector would run off the
+//	bottom of the stack, into the program's data.)
+//
+//	"virtAddr" -- where the vector is in the user program; if 0,
+//		there are no arguments
+//----------------------------------------------------------------------
+
+static ExecArgs *
+FetchExecArgs(int virtAddr)
+{
+    ExecArgs *args = new ExecArgs;
+    char arg[MaxArgSize];
+    int argAddr, length;
+    int bytes = 16 + sizeof(int);	// save area, and the null pointer
+
+    args->argc = 0;
+    args->argv = new char *[MaxArgs];
+    args->startTicks = stats->totalTicks;
+    if (virtAddr == 0)
+	return args;
+    for (;;) {
+	if (!CopyIn(virtAddr + args->argc * sizeof(int), (char *) &argAddr, 
+								sizeof(int))) {
+	    FreeExecArgs(args);
+	    return NULL;
+	}
+	argAddr = WordToHost(argAddr);
+	if (argAddr == 0)
+	    return args;			// end of the vector
+	length = CopyInString(argAddr, arg, MaxArgSize);
+	if ((length < 0) || (args->argc == MaxArgs)) {
+	    FreeExecArgs(args);
+	    return NULL;
+	}
+	bytes += divRoundUp(length + 1, sizeof(int)) * sizeof(int) 
+							+ sizeof(int);
+	if (bytes >= MaxArgBytes) {
+	    DEBUG('a', "Exec: arguments too big for the stack\n");
+	    FreeExecArgs(args);
+	    return NULL;
+	}
+	args->argv[args->argc] = new char[length + 1];
+	strcpy(args->argv[args->argc++], arg);
+    }
+}
+
+//----------------------------------------------------------------------
+// ExecProcess
+// 	The first thing a process created by Exec does, in the kernel:
+//	switch to the new address space, and lay out its arguments at the
+//	top of the stack, for main(argc, argv):
+//
+//		the strings, each word-aligned
+//		argv[0] .. argv[argc - 1], then a null pointer
+//		16 bytes of argument save area, as the MIPS convention wants
+//
+//	with the stack pointer below all of it.  Then jump to the start
+//	of the program.
+//
+//	"arg" -- the ExecArgs, which are freed here
+//----------------------------------------------------------------------
+
+static void
+ExecProcess(int arg)
+{
+    ExecArgs *args = (ExecArgs *) arg;
+    int argvAddr[MaxArgs + 1];
+    int sp, i, length, ticks;
+
+    currentThread->space->InitRegisters();
+    currentThread->space->RestoreState();
+
+    sp = machine->ReadRegister(StackReg);
+    for (i = 0; i < args->argc; i++) {
+	length = strlen(args->argv[i]) + 1;
+	sp -= divRoundUp(length, sizeof(int)) * sizeof(int);
+	if (!CopyOut(args->argv[i], sp, length))
+	    ASSERT(FALSE);		// the stack is always there
+	argvAddr[i] = WordToHost(sp);
+    }
+    argvAddr[args->argc] = 0;
+    sp -= (args->argc + 1) * sizeof(int);
+    if (!CopyOut((char *) argvAddr, sp, (args->argc + 1) * sizeof(int)))
+	ASSERT(FALSE);
+    machine->WriteRegister(4, args->argc);
+    machine->WriteRegister(5, sp);
+    machine->WriteRegister(StackReg, sp - 16);
+
+    ticks = stats->totalTicks - args->startTicks;
+    stats->numExecs++;
+    stats->execTicks += ticks;
+    stats->maxExecTicks = max(stats->maxExecTicks, ticks);
+    DEBUG('a', "Exec'ed process %d starting, %d ticks after Exec\n", 
+				currentThread->pcb->getID(), ticks);
+    FreeExecArgs(args);
+
+    machine->Run();			// never returns; the process
+    ASSERT(FALSE);			// ends with Exit
+}
+
+//----------------------------------------------------------------------
+// Exec
+// 	Start a new process running the program named by the string at
+//	r4, with the null-terminated argument vector at r5 (or none if r5
+//	is 0).  Return its SpaceId in r2, or -1 if the program can't be
+//	run: it can't be opened, isn't a NOFF executable, or doesn't fit
+//	in memory, or the arguments are bad.
+//
+//	Everything is checked and copied from the caller before the new
+//	process exists.  The program is loaded here, in the caller, 
+//	except that with virtual memory its pages come in on demand.
+//----------------------------------------------------------------------
+
+void Exec() {
+    char name[MaxFileNameSize];
+    OpenFile *executable;
+    AddrSpace *space;
+    ExecArgs *args;
+    Thread *child;
+
+    DEBUG('a', "Exec, initiated by user program.\n");
+    if (CopyInString(machine->ReadRegister(4), name, MaxFileNameSize) < 0) {
+        machine->WriteRegister(2, -1);
+        return;
+    }
+    args = FetchExecArgs(machine->ReadRegister(5));
+    if (args == NULL) {
+        machine->WriteRegister(2, -1);
+        return;
+    }
+    executable = fileSystem->Open(name);
+    if (executable == NULL) {
+        DEBUG('a', "Exec: unable to open file %s\n", name);
+        FreeExecArgs(args);
+        machine->WriteRegister(2, -1);
+        return;
+    }
+
+    space = new AddrSpace(executable);
+#ifndef VM
+    delete executable;			// with VM, the address space keeps
+#endif					// it, to load pages on demand
+    if (!space->IsValid()) {
+        DEBUG('a', "Exec: can't run %s\n", name);
+        delete space;
+        FreeExecArgs(args);
+        machine->WriteRegister(2, -1);
+        return;
+    }
+
+    child = new Thread("exec'ed process");
+    child->space = space;
+    child->pcb = new PCB(child);
+    child->pcb->setSpace(child->space);
+    processManager->lock->Acquire();
+    child->pcb->setParent(currentThread->pcb);
+    currentThread->pcb->addChild(child->pcb);
+    processManager->lock->Release();
+
+    DEBUG('a', "Exec %s -> process %d\n", name, child->pcb->getID());
+    machine->WriteRegister(2, child->pcb->getID());
+    child->Fork(ExecProcess, (int) args);
+}
+
+//----------------------------------------------------------------------
+// GetConsole
+// 	Return the console, creating it the first time a program uses
+//	it.  It isn't created when Nachos starts, because once it exists
+//	it keeps polling for input, and Nachos never runs out of things
+//	to do; a program that uses the console must end with Halt.
+//----------------------------------------------------------------------
+
+static SynchConsole *
+GetConsole()
+{
+    if (synchConsole == NULL)
+	synchConsole = new SynchConsole(NULL, NULL);
+    return synchConsole;
+}
+
+//----------------------------------------------------------------------
+// Create
+// 	Create an empty file whose name is the string at r4.
+//----------------------------------------------------------------------
+
+void Create() {
+    char name[MaxFileNameSize];
+
+    DEBUG('a', "Create, initiated by user program.\n");
+    if (CopyInString(machine->ReadRegister(4), name, MaxFileNameSize) < 0) {
+        DEBUG('a', "Create: bad file name\n");
+        return;
+    }
+    if (!openFileTable->Create(name))
+        DEBUG('a', "Create: can't create %s\n", name);
+}
+
+//----------------------------------------------------------------------
+// Open
+// 	Open the file whose name is the string at r4, and return a new
+//	descriptor for it in r2, or -1 if it can't be opened.
+//----------------------------------------------------------------------
+
+void Open() {
+    char name[MaxFileNameSize];
+    SysOpenFile *file;
+    int fd = -1;
+
+    DEBUG('a', "Open, initiated by user program.\n");
+    if (CopyInString(machine->ReadRegister(4), name, MaxFileNameSize) >= 0) {
+        file = openFileTable->Open(name);
+        if (file != NULL) {
+            fd = currentThread->pcb->addFile(file);
+            if (fd < 0)				// no free descriptor
+                openFileTable->Close(file);
+        }
+    }
+    DEBUG('a', "Open %s -> %d\n", name, fd);
+    machine->WriteRegister(2, fd);
+}
+
+//----------------------------------------------------------------------
+// LookupFile
+// 	Find the open file for a descriptor of the current process.
+//	Returns FALSE if the descriptor isn't open for the direction
+//	asked for; otherwise "file" is set, to NULL for the console.
+//
+//	The file comes with a reference, which the caller drops with
+//	ReleaseFile when the transfer is done.  Another thread of the
+//	process may Close the descriptor while we wait for the disk;
+//	the file stays open until we are finished with it.
+//
+//	"fd" -- the descriptor
+//	"writing" -- TRUE for a write, FALSE for a read
+//	"file" -- where to return the open file
+//----------------------------------------------------------------------
+
+static bool
+LookupFile(int fd, bool writing, SysOpenFile **file)
+{
+    *file = NULL;
+    if (fd == (writing ? ConsoleOutput : ConsoleInput))
+	return TRUE;
+    *file = currentThread->pcb->getFile(fd);
+    return (*file != NULL);
+}
+
+//----------------------------------------------------------------------
+// ReleaseFile
+// 	Drop the reference LookupFile took.
+//
+//	"file" -- the open file, or NULL for the console
+//----------------------------------------------------------------------
+
+static void
+ReleaseFile(SysOpenFile *file)
+{
+    if (file != NULL)
+	openFileTable->Close(file);
+}
+
+//----------------------------------------------------------------------
+// FetchIOVecs
+// 	Copy the segment list of a ReadV or WriteV into the kernel: "count"
+//	IOVec's, each a user buffer address and a size.  Returns the total
+//	size, or -1 if the list or any size is bad, or the sizes add up to
+//	more than fits in an int.
+//
+//	"virtAddr" -- where the list is in the user program
+//	"count" -- how many segments
+//	"vecs" -- where to put them; 2 * "count" words
+//----------------------------------------------------------------------
+
+static int
+FetchIOVecs(int virtAddr, int count, int *vecs)
+{
+    int i, total = 0;
+
+    if ((count < 0) || (count > MaxIOVecs))
+	return -1;
+    if (!CopyIn(virtAddr, (char *) vecs, count * 2 * sizeof(int)))
+	return -1;
+    for (i = 0; i < 2 * count; i += 2) {
+	vecs[i] = WordToHost(vecs[i]);
+	vecs[i + 1] = WordToHost(vecs[i + 1]);
+	if ((vecs[i + 1] < 0) || (vecs[i + 1] > INT_MAX - total))
+	    return -1;
+	total += vecs[i + 1];
+    }
+    return total;
+}
+
+//----------------------------------------------------------------------
+// ReadSegments
+// 	Read from an open file (or the console) into a list of user
+//	buffers, filling each in turn.  Returns the number of bytes read,
+//	or -1 if a buffer is bad.
+//
+//	The file is read with as few calls as possible -- one per
+//	IOChunkSize bytes, however many segments there are -- into a
+//	kernel buffer, which is then scattered a page at a time (see
+//	usermem.cc).  A read from the console stops after whatever has
+//	been typed, and a read from a file stops at the end of the file.
+//
+//	"file" -- the file, or NULL for the console
+//	"vecs" -- the user buffers, as address/size pairs
+//	"count" -- how many buffers
+//	"size" -- their total size
+//----------------------------------------------------------------------
+
+static int
+ReadSegments(SysOpenFile *file, int *vecs, int count, int size)
+{
+    char *buffer = new char[min(size, IOChunkSize)];
+    int seg = 0, offset = 0, total = 0;
+    int chunk, numRead, done, n;
+
+    while (total < size) {
+	chunk = min(size - total, IOChunkSize);
+	if (file == NULL)
+	    numRead = GetConsole()->Read(buffer, chunk);
+	else
+	    numRead = file->Read(buffer, chunk);
+	if (numRead <= 0)
+	    break;
+	for (done = 0; done < numRead; done += n) {	// scatter
+	    while (offset == vecs[2 * seg + 1]) {	// next segment
+		seg++;
+		offset = 0;
+	    }
+	    n = min(numRead - done, vecs[2 * seg + 1] - offset);
+	    if (!CopyOut(buffer + done, vecs[2 * seg] + offset, n)) {
+		delete [] buffer;
+		return -1;
+	    }
+	    offset += n;
+	}
+	total += numRead;
+	if ((file == NULL) || (numRead < chunk))
+	    break;			// that's all there is, for now
+    }
+    delete [] buffer;
+    return total;
+}
+
+//----------------------------------------------------------------------
+// WriteSegments
+// 	Write a list of user buffers, one after the other, to an open
+//	file (or the console).  Returns the number of bytes written, or -1
+//	if a buffer is bad.
+//
+//	The segments are gathered into a kernel buffer, and written with
+//	one call per IOChunkSize bytes, so however small the segments
+//	are, the file system sees large writes; only the first and last
+//	sectors of each can need a read-modify-write (see
+//	OpenFile::WriteAt).
+//
+//	"file" -- the file, or NULL for the console
+//	"vecs" -- the user buffers, as address/size pairs
+//	"count" -- how many buffers
+//	"size" -- their total size
+//----------------------------------------------------------------------
+
+static int
+WriteSegments(SysOpenFile *file, int *vecs, int count, int size)
+{
+    char *buffer = new char[min(size, IOChunkSize)];
+    int seg, offset, n, filled = 0, total = 0;
+    int numWritten;
+
+    for (seg = 0; seg < count; seg++)
+	for (offset = 0; offset < vecs[2 * seg + 1]; offset += n) {
+	    n = min(vecs[2 * seg + 1] - offset, IOChunkSize - filled);
+	    if (!CopyIn(vecs[2 * seg] + offset, buffer + filled, n)) {
+		delete [] buffer;
+		return -1;
+	    }
+	    filled += n;
+	    if ((filled < IOChunkSize) && (total + filled < size))
+		continue;			// gather some more
+
+	    if (file == NULL) {
+		GetConsole()->Write(buffer, filled);
+		numWritten = filled;
+	    } else
+		numWritten = file->Write(buffer, filled);
+	    if (numWritten > 0)
+		total += numWritten;
+	    if (numWritten < filled) {		// the disk is full
+		delete [] buffer;
+		return total;
+	    }
+	    filled = 0;
+	}
+    delete [] buffer;
+    return total;
+}
+
+//----------------------------------------------------------------------
+// Read
+// 	Read up to r5 bytes from descriptor r6 into the user buffer at r4,
+//	and return the number of bytes read in r2, or -1 on error.
+//----------------------------------------------------------------------
+
+void Read() {
+    int vec[2];
+    int fd = machine->ReadRegister(6);
+    SysOpenFile *file;
+
+    vec[0] = machine->ReadRegister(4);
+    vec[1] = machine->ReadRegister(5);
+    DEBUG('a', "Read %d bytes from %d, initiated by user program.\n",
+								vec[1], fd);
+    if ((vec[1] < 0) || !LookupFile(fd, FALSE, &file))
+        machine->WriteRegister(2, -1);
+    else {
+        machine->WriteRegister(2, ReadSegments(file, vec, 1, vec[1]));
+        ReleaseFile(file);
+    }
+}
+
+//----------------------------------------------------------------------
+// Write
+// 	Write r5 bytes from the user buffer at r4 to descriptor r6, and 
+//	return the number of bytes written in r2, or -1 on error.
+//----------------------------------------------------------------------
+
+void Write() {
+    int vec[2];
+    int fd = machine->ReadRegister(6);
+    SysOpenFile *file;
+
+    vec[0] = machine->ReadRegister(4);
+    vec[1] = machine->ReadRegister(5);
+    DEBUG('a', "Write %d bytes to %d, initiated by user program.\n",
+								vec[1], fd);
+    if ((vec[1] < 0) || !LookupFile(fd, TRUE, &file))
+        machine->WriteRegister(2, -1);
+    else {
+        machine->WriteRegister(2, WriteSegments(file, vec, 1, vec[1]));
+        ReleaseFile(file);
+    }
+}
+
+//----------------------------------------------------------------------
+// ReadV
+// 	Read from descriptor r6 into the r5 buffers listed at r4, and
+//	return the number of bytes read in r2, or -1 on error.
+//----------------------------------------------------------------------
+
+void ReadV() {
+    int vecs[2 * MaxIOVecs];
+    int count = machine->ReadRegister(5);
+    int fd = machine->ReadRegister(6);
+    SysOpenFile *file;
+    int size;
+
+    DEBUG('a', "ReadV of %d segments from %d, initiated by user program.\n",
+								count, fd);
+    size = FetchIOVecs(machine->ReadRegister(4), count, vecs);
+    if ((size < 0) || !LookupFile(fd, FALSE, &file))
+        machine->WriteRegister(2, -1);
+    else {
+        machine->WriteRegister(2, ReadSegments(file, vecs, count, size));
+        ReleaseFile(file);
+    }
+}
+
+//----------------------------------------------------------------------
+// WriteV
+// 	Write the r5 buffers listed at r4, in order, to descriptor r6, and
+//	return the number of bytes written in r2, or -1 on error.
+//----------------------------------------------------------------------
+
+void WriteV() {
+    int vecs[2 * MaxIOVecs];
+    int count = machine->ReadRegister(5);
+    int fd = machine->ReadRegister(6);
+    SysOpenFile *file;
+    int size;
+
+    DEBUG('a', "WriteV of %d segments to %d, initiated by user program.\n",
+								count, fd);
+    size = FetchIOVecs(machine->ReadRegister(4), count, vecs);
+    if ((size < 0) || !LookupFile(fd, TRUE, &file))
+        machine->WriteRegister(2, -1);
+    else {
+        machine->WriteRegister(2, WriteSegments(file, vecs, count, size));
+        ReleaseFile(file);
+    }
+}
+
+//----------------------------------------------------------------------
+// Close
+// 	Close descriptor r4.  The file itself is closed when no process 
+//	has a descriptor for it any more.
+//----------------------------------------------------------------------
+
+void Close() {
+    int fd = machine->ReadRegister(4);
+    SysOpenFile *file = currentThread->pcb->removeFile(fd);
+
+    DEBUG('a', "Close %d, initiated by user program.\n", fd);
+    if (file != NULL)
+        openFileTable->Close(file);
 }
@@ -0,0 +1,199 @@
+// filetable.cc
+//	Routines to manage the system-wide table of files opened by
+//	user programs.  See filetable.h for how the locking works.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "system.h"
+#include "filetable.h"
+
+//----------------------------------------------------------------------
+// SysOpenFile::SysOpenFile
+// 	Initialize an open file table entry, positioned at the start of
+//	the file, with one reference.
+//
+//	"openFile" -- the file, already opened by the file system
+//----------------------------------------------------------------------
+
+SysOpenFile::SysOpenFile(OpenFile *openFile)
+{
+    file = openFile;
+    position = 0;
+    refCount = 1;
+    lock = new Lock("open file");
+}
+
+//----------------------------------------------------------------------
+// SysOpenFile::~SysOpenFile
+// 	Close the file.
+//----------------------------------------------------------------------
+
+SysOpenFile::~SysOpenFile()
+{
+    delete lock;
+    delete file;
+}
+
+//----------------------------------------------------------------------
+// SysOpenFile::Read
+// SysOpenFile::Write
+// 	Read or write part of the file at the seek position, and move
+//	the position past it.  Nobody else can move the position while
+//	this is going on.
+//
+//	Return the number of bytes actually read or written.
+//
+//	"into"/"from" -- the kernel buffer to read into, or write from
+//	"numBytes" -- how many bytes to read or write
+//----------------------------------------------------------------------
+
+int
+SysOpenFile::Read(char *into, int numBytes)
+{
+    int numRead;
+
+    lock->Acquire();
+    numRead = file->ReadAt(into, numBytes, position);
+    if (numRead > 0)
+	position += numRead;
+    lock->Release();
+    return numRead;
+}
+
+int
+SysOpenFile::Write(char *from, int numBytes)
+{
+    int numWritten;
+
+    lock->Acquire();
+    numWritten = file->WriteAt(from, numBytes, position);
+    if (numWritten > 0)
+	position += numWritten;
+    lock->Release();
+    return numWritten;
+}
+
+//----------------------------------------------------------------------
+// OpenFileTable::OpenFileTable
+// 	Initialize the system-wide open file table, with every entry free.
+//
+//	"tableSize" -- the most files that can be open at once
+//----------------------------------------------------------------------
+
+OpenFileTable::OpenFileTable(int tableSize)
+{
+    int i;
+
+    size = tableSize;
+    table = new SysOpenFile *[size];
+    for (i = 0; i < size; i++)
+	table[i] = NULL;
+    lock = new Lock("open file table");
+}
+
+//----------------------------------------------------------------------
+// OpenFileTable::~OpenFileTable
+// 	Close any files that are still open, and de-allocate the table.
+//----------------------------------------------------------------------
+
+OpenFileTable::~OpenFileTable()
+{
+    int i;
+
+    for (i = 0; i < size; i++)
+	if (table[i] != NULL)
+	    delete table[i];
+    delete [] table;
+    delete lock;
+}
+
+//----------------------------------------------------------------------
+// OpenFileTable::Create
+// 	Create an empty file.  Returns FALSE if the file system can't.
+//
+//	"name" -- the file's name, in kernel memory
+//----------------------------------------------------------------------
+
+bool
+OpenFileTable::Create(char *name)
+{
+    bool success;
+
+    lock->Acquire();		// the file system isn't re-entrant
+    success = fileSystem->Create(name, 0);
+    lock->Release();
+    return success;
+}
+
+//----------------------------------------------------------------------
+// OpenFileTable::Open
+// 	Open a file, and give it a new entry in the table, positioned at
+//	the start of the file.  As in UNIX, opening a file that is already
+//	open gets a new entry, with its own seek position.
+//
+//	Returns NULL if there is no such file, or the table is full.
+//
+//	"name" -- the file's name, in kernel memory
+//----------------------------------------------------------------------
+
+SysOpenFile *
+OpenFileTable::Open(char *name)
+{
+    SysOpenFile *entry = NULL;
+    OpenFile *file;
+    int i;
+
+    lock->Acquire();
+    for (i = 0; i < size; i++)
+	if (table[i] == NULL)
+	    break;
+    if (i < size) {
+	file = fileSystem->Open(name);
+	if (file != NULL)
+	    entry = table[i] = new SysOpenFile(file);
+    }
+    lock->Release();
+    return entry;
+}
+
+//----------------------------------------------------------------------
+// OpenFileTable::Share
+// 	Add a reference to an entry, for a new descriptor that shares it.
+//
+//	"entry" -- an entry in the table
+//----------------------------------------------------------------------
+
+void
+OpenFileTable::Share(SysOpenFile *entry)
+{
+    lock->Acquire();
+    entry->refCount++;
+    lock->Release();
+}
+
+//----------------------------------------------------------------------
+// OpenFileTable::Close
+// 	Drop a reference to an entry, for a descriptor that is being
+//	closed.  The last reference closes the file and frees the entry.
+//
+//	"entry" -- an entry in the table
+//----------------------------------------------------------------------
+
+void
+OpenFileTable::Close(SysOpenFile *entry)
+{
+    int i;
+
+    lock->Acquire();
+    ASSERT(entry->refCount > 0);
+    if (--entry->refCount == 0) {
+	for (i = 0; i < size; i++)
+	    if (table[i] == entry)
+		table[i] = NULL;
+	delete entry;
+    }
+    lock->Release();
+}
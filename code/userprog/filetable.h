@@ -0,0 +1,73 @@
+// filetable.h
+//	Data structures for the system-wide table of files opened by
+//	user programs.
+//
+//	As in UNIX, each process has its own table of file descriptors
+//	(see pcb.h), each pointing at an entry in this table.  The entry
+//	holds the seek position, so processes that share an entry (a
+//	process and the children it Forks) share the position too.  An
+//	entry is reference counted, and the file is closed when the last
+//	descriptor for it goes away.
+//
+//	There is no lock around a whole system call.  The table's lock is
+//	held only while an entry is found or freed (and while the file
+//	system is asked to open or create a file); a read or write holds
+//	only the lock of its own entry, so that the seek position moves
+//	atomically.  Programs doing I/O on different files don't wait
+//	for each other.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef FILETABLE_H
+#define FILETABLE_H
+
+#include "copyright.h"
+#include "openfile.h"
+#include "synch.h"
+
+#define MaxSysOpenFiles	64		// open files in the whole system
+#define MaxFileNameSize	256		// longest name passed to Create/Open,
+					// counting the null
+#define IOChunkSize	4096		// kernel buffer for Read and Write
+
+// An entry in the system-wide open file table.
+
+class SysOpenFile {
+  public:
+    SysOpenFile(OpenFile *openFile);// Wrap an open file; one reference
+    ~SysOpenFile();			// Close the file
+
+    int Read(char *into, int numBytes);	// Read/write at the seek position,
+    int Write(char *from, int numBytes);// and advance it
+
+    OpenFile *file;			// the file itself
+    int position;			// seek position, shared by every
+					// descriptor for this entry
+    int refCount;			// how many descriptors there are
+    Lock *lock;				// protects "position", and keeps
+					// reads and writes atomic
+};
+
+// The system-wide open file table.
+
+class OpenFileTable {
+  public:
+    OpenFileTable(int tableSize);	// Initialize; nothing open
+    ~OpenFileTable();			// Close anything still open
+
+    bool Create(char *name);		// Create an empty file
+    SysOpenFile *Open(char *name);	// Open a file, with a new entry;
+					// NULL if it can't be opened, or
+					// the table is full
+    void Share(SysOpenFile *entry);	// Add a reference to an entry
+    void Close(SysOpenFile *entry);	// Drop a reference to an entry
+
+  private:
+    SysOpenFile **table;		// the entries; NULL if free
+    int size;				// number of entries
+    Lock *lock;				// protects "table" and refCounts
+};
+
+#endif // FILETABLE_H
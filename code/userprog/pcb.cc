@@ -1,16 +1,34 @@
 #include "pcb.h"
+#include "system.h"
+#include "syscall.h"
 
+// Enter a new process in the process table, which gives it its PID. 
 PCB::PCB(Thread* input) {
 	processThread = input; 
-	processID = pid_manager->getPid(); 
+	processManager->lock->Acquire(); 
+	processID = processManager->addPCB(this); 
+	processManager->lock->Release(); 
 	parent_process = NULL; 
-	MAX_FILES = 16; //arbitrary? 
-	children = new ProcMan(); 
+	address_space = NULL; 
+	exited = false; 
+	exitStatus = 0; 
+	exitCondition = new Condition("exit"); 
+	for(int i = 0; i < MaxOpenFiles; i++) {
+		openFiles[i] = NULL; 
+	}
+	firstChild = nextSibling = prevSibling = NULL; 
+	childCount = 0; 
+	threadCount = 1; 
+	lock = new Lock("pcb"); 
 }
 
+// Take the process out of the process table.  The caller holds 
+// processManager->lock, and has dealt with the children. 
 PCB::~PCB() {
+	closeAllFiles(); 
+	processManager->removePCB(processID); 
+	delete exitCondition; 
 	delete lock; 
-	delete children; 
 }
 
 int PCB::getID() {
@@ -37,22 +55,166 @@ void PCB::setSpace(AddrSpace* space) {
 	address_space = space; 
 }
 
+// The parent/child routines are called with processManager->lock held. 
 bool PCB::addChild(PCB* child) {
-	return children->addPCB(child); 
+	child->prevSibling = NULL; 
+	child->nextSibling = firstChild; 
+	if(firstChild != NULL) {
+		firstChild->prevSibling = child; 
+	}
+	firstChild = child; 
+	childCount++; 
+	return true; 
 }
 
 bool PCB::removeChild(int pid) {
-	return children->removePCB(pid); 
+	PCB* child = findChild(pid); 
+
+	if(child == NULL) {
+		return false; 
+	}
+	if(child->prevSibling != NULL) {
+		child->prevSibling->nextSibling = child->nextSibling; 
+	} else {
+		firstChild = child->nextSibling; 
+	}
+	if(child->nextSibling != NULL) {
+		child->nextSibling->prevSibling = child->prevSibling; 
+	}
+	child->nextSibling = child->prevSibling = NULL; 
+	childCount--; 
+	return true; 
 }
 
+// The process table finds the PCB; all we check is that it's ours. 
 PCB* PCB::findChild(int pid) {
-	return children->getPCB(pid); 
+	PCB* child = processManager->getPCB(pid); 
+
+	if(child == NULL || child->getParent() != this) {
+		return NULL; 
+	}
+	return child; 
 }
 
 int PCB::numChildren() {
-	return children->getProcCount(); 
+	return childCount; 
 }
 
+// Called when this process exits: no one will Join its children now, 
+// so those that have exited are reaped, and the rest are on their own. 
 void PCB::orphanize() {
-	return children->orphanize(); 
-}
\ No newline at end of file
+	PCB* child; 
+
+	while((child = firstChild) != NULL) {
+		firstChild = child->nextSibling; 
+		child->nextSibling = child->prevSibling = NULL; 
+		child->setParent(NULL); 
+		if(child->hasExited()) {
+			delete child; 
+		}
+	}
+	childCount = 0; 
+}
+
+void PCB::setExitStatus(int status) {
+	exitStatus = status; 
+	exited = true; 
+	exitCondition->Broadcast(processManager->lock); 
+}
+
+// Sleep, without using the CPU, until the process exits.  The PCB may 
+// have been reaped by the time we wake up, so the caller must look the 
+// process up again. 
+void PCB::waitForExit() {
+	if(!exited) {
+		exitCondition->Wait(processManager->lock); 
+	}
+}
+
+bool PCB::hasExited() {
+	return exited; 
+}
+
+int PCB::getExitStatus() {
+	return exitStatus; 
+}
+
+void PCB::addThread() {
+	lock->Acquire(); 
+	threadCount++; 
+	lock->Release(); 
+}
+
+int PCB::removeThread() {
+	int left; 
+
+	lock->Acquire(); 
+	left = --threadCount; 
+	lock->Release(); 
+	return left; 
+}
+
+// Put "file" in the first free descriptor, above the console's. 
+int PCB::addFile(SysOpenFile* file) {
+	lock->Acquire(); 
+	for(int fd = ConsoleOutput + 1; fd < MaxOpenFiles; fd++) {
+		if(openFiles[fd] == NULL) {
+			openFiles[fd] = file; 
+			lock->Release(); 
+			return fd; 
+		}
+	}
+	lock->Release(); 
+	return -1; 
+}
+
+// The caller gets a reference, so the entry stays open while it is in 
+// use even if another of our threads closes "fd"; openFileTable->Close 
+// drops it. 
+SysOpenFile* PCB::getFile(int fd) {
+	SysOpenFile* file; 
+
+	if(fd < 0 || fd >= MaxOpenFiles) {
+		return NULL; 
+	}
+	lock->Acquire(); 
+	file = openFiles[fd]; 
+	if(file != NULL) {
+		openFileTable->Share(file); 
+	}
+	lock->Release(); 
+	return file; 
+}
+
+// Take "fd" out of the table; the caller drops the reference. 
+SysOpenFile* PCB::removeFile(int fd) {
+	SysOpenFile* file; 
+
+	if(fd < 0 || fd >= MaxOpenFiles) {
+		return NULL; 
+	}
+	lock->Acquire(); 
+	file = openFiles[fd]; 
+	openFiles[fd] = NULL; 
+	lock->Release(); 
+	return file; 
+}
+
+// A forked child gets the same descriptors, sharing the seek positions. 
+void PCB::inheritFiles(PCB* parent) {
+	for(int fd = 0; fd < MaxOpenFiles; fd++) {
+		if(parent->openFiles[fd] != NULL) {
+			openFileTable->Share(parent->openFiles[fd]); 
+			openFiles[fd] = parent->openFiles[fd]; 
+		}
+	}
+}
+
+void PCB::closeAllFiles() {
+	for(int fd = 0; fd < MaxOpenFiles; fd++) {
+		SysOpenFile* file = removeFile(fd); 
+		if(file != NULL) {
+			openFileTable->Close(file); 
+		}
+	}
+}
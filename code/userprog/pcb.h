@@ -6,6 +6,9 @@
 #include "thread.h"
 #include "list.h"
 #include "procman.h"
+#include "filetable.h"
+
+#define MaxOpenFiles 16 	// descriptors per process, counting the console
 
 class Thread;
 class Lock; 
@@ -26,15 +29,47 @@ public:
 	bool removeChild(int pid); 
 	PCB* findChild(int pid); 
 	int numChildren(); 
-	void orphanize(); 
+	void orphanize(); 	// children lose their parent; zombies go 
+
+	// Exit status.  An exited process stays in the process table, as 
+	// a zombie, until its parent Joins it or exits itself. 
+	void setExitStatus(int status); // and wake up a Join 
+	void waitForExit(); 		// sleep until it may have exited 
+	bool hasExited(); 
+	int getExitStatus(); 
+
+	// User threads.  The process ends when the last one exits. 
+	void addThread(); 
+	int removeThread(); 		// returns how many are left 
+
+	// Per-process descriptor table.  Descriptors 0 and 1 are the console 
+	// (ConsoleInput and ConsoleOutput), and are never in the table. 
+	int addFile(SysOpenFile* file); // returns the new descriptor, or -1 
+	SysOpenFile* getFile(int fd); 	// with a reference; NULL if "fd" 
+					// isn't open 
+	SysOpenFile* removeFile(int fd); 
+	void inheritFiles(PCB* parent); // share the parent's open files 
+	void closeAllFiles(); 
 
 	Lock* lock; 
-	ProcMan* children; 
 
 private: 
-	int MAX_FILES; 
+	SysOpenFile* openFiles[MaxOpenFiles]; 
 	Thread* processThread; 
 	int processID; 
 	PCB* parent_process; 
 	AddrSpace* address_space; 
-};
\ No newline at end of file
+	bool exited; 
+	int exitStatus; 
+	Condition* exitCondition; 	// signalled when the process exits 
+
+	// Children are kept on a doubly linked list running through their 
+	// own PCBs, so adding or removing one is O(1) with no allocation. 
+	PCB* firstChild; 
+	PCB* nextSibling; 
+	PCB* prevSibling; 
+	int childCount; 
+	int threadCount; 
+};
+
+#endif // PCB_H
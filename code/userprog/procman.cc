@@ -1,67 +1,82 @@
 #include "procman.h"
+#include "synch.h"
 
 ProcMan::ProcMan() {
-	procCount = 0; 
-	for(int i = 0; i < 32; i++) {
+	tableSize = InitialProcesses; 
+	procArray = new PCB*[tableSize]; 
+	for(int i = 0; i < tableSize; i++) {
 		procArray[i] = NULL; 
-		occupied[i] = false; 
 	}
+	freePids = new int[tableSize]; 
+	freeHead = freeCount = 0; 
+	procCount = 0; 
+	nextFreshPid = 1; 	// PID 0 is never used, so it can't look like NULL 
+	lock = new Lock("process table"); 
 }
 
 ProcMan::~ProcMan(){
-	delete procArray; 
-	delete occupied; 
+	delete [] procArray; 
+	delete [] freePids; 
+	delete lock; 
 }
 
-bool ProcMan::addPCB(PCB *toAdd){
-	for(int i = 0; i < 32; i++) {
-		if(!occupied[i]) {
-			procCount++; 
-			procArray[i] = toAdd; 
-			occupied[i] = true; 
-			return true; 
+int ProcMan::addPCB(PCB *toAdd){
+	int pid; 
+
+	if(freeCount > PidReuseDelay) {
+		pid = freePids[freeHead]; 
+		freeHead = (freeHead + 1) % tableSize; 
+		freeCount--; 
+	} else {
+		if(nextFreshPid == tableSize) {
+			grow(); 
 		}
+		pid = nextFreshPid++; 
 	}
-	return false; 
+	ASSERT(procArray[pid] == NULL); 
+	procArray[pid] = toAdd; 
+	procCount++; 
+	return pid; 
 }
 
 bool ProcMan::removePCB(int pid) {
-	for(int i = 0; i < 32; i++) {
-		if(occupied[i] && procArray[i]->getID() == pid) {
-			procArray[i] = NULL; 
-			occupied[i] = false; 
-			procCount--; 
-			return true; 
-		}
+	if(getPCB(pid) == NULL) {
+		return false; 
 	}
-	return false; 
+	procArray[pid] = NULL; 
+	procCount--; 
+	freePids[(freeHead + freeCount) % tableSize] = pid; 
+	freeCount++; 
+	return true; 
 }
 
 PCB* ProcMan::getPCB(int pid) {
-	for(int i = 0; i < 32; i++) {
-		if(occupied[i] && procArray[i]->getID() == pid) {
-			return procArray[i]; 
-		}
+	if(pid <= 0 || pid >= tableSize) {
+		return NULL; 
 	}
-	return NULL; 
+	return procArray[pid]; 
 }
 
 int ProcMan::getProcCount() {
 	return procCount; 
 }
 
-void ProcMan::adopt(PCB *parent) {
-	for(int i = 0; i < 32; i++) {
-		if(occupied[i]) {
-			procArray[i]->setParent(parent); 
-		}
-	}
-}
+void ProcMan::grow() {
+	int newSize = 2 * tableSize; 
+	PCB** newArray = new PCB*[newSize]; 
+	int* newFree = new int[newSize]; 
 
-void ProcMan::orphanize() {
-	for(int i = 0; i < 32; i++) {
-		if(occupied[i]) {
-			procArray[i]->setParent(NULL); 
-		}
+	DEBUG('a', "Growing the process table to %d entries\n", newSize); 
+	for(int i = 0; i < newSize; i++) {
+		newArray[i] = (i < tableSize) ? procArray[i] : NULL; 
 	}
-}
\ No newline at end of file
+	for(int i = 0; i < freeCount; i++) {
+		newFree[i] = freePids[(freeHead + i) % tableSize]; 
+	}
+	delete [] procArray; 
+	delete [] freePids; 
+	procArray = newArray; 
+	freePids = newFree; 
+	freeHead = 0; 
+	tableSize = newSize; 
+}
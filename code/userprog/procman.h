@@ -9,22 +9,43 @@ class Thread;
 class AddrSpace;
 class Lock; 
 
+#define InitialProcesses 64 	// size of the process table to start with; 
+				// it doubles whenever it fills up 
+#define PidReuseDelay 32 	// a freed PID isn't handed out again until 
+				// this many more have been freed after it 
+
+// The system-wide process table.  A process's PID is its index in the 
+// table, so finding a process (for Join) doesn't search anything. 
+//
+// Freed PIDs go on a first-in first-out list, and a new process gets 
+// the oldest of them, but only once there are more than PidReuseDelay 
+// on the list; until then it gets a PID never used before.  So getting 
+// a PID is O(1) (amortized over growing the table), and a PID stays 
+// unused for a good while after its process is reaped, in case 
+// something still has the old number. 
 class ProcMan {
 public: 
 	ProcMan();
 	~ProcMan(); 
-	bool addPCB(PCB *toAdd); 
-	bool removePCB(int pid); 
-	bool getPCB(int pid); 
+	int addPCB(PCB *toAdd); 	// enter a new process; returns its PID 
+	bool removePCB(int pid); 	// and put the PID on the free list 
+	PCB* getPCB(int pid); 
 	int getProcCount(); 
-	void adopt(PCB *parent); 
-	void orphanize(); 
+
+	Lock* lock; 	// protects parent/child links and exit status, 
+			// between Exit and Join 
 private: 
-	PCB* procArray[32]; 
-	bool occupied[32]; 
+	void grow(); 	// double the size of the table 
+
+	PCB** procArray; 	// indexed by PID; NULL if free 
+	int tableSize; 
 	int procCount; 
-}
+	int nextFreshPid; 	// lowest PID never handed out 
+	int* freePids; 		// circular queue of freed PIDs, oldest first; 
+	int freeHead; 		// it can't hold more than "tableSize" 
+	int freeCount; 
+};
 
 
 
-#endif
\ No newline at end of file
+#endif
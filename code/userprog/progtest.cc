@@ -12,6 +12,7 @@
 #include "system.h"
 #include "console.h"
 #include "addrspace.h"
+#include "pcb.h"
 #include "synch.h"
 
 //----------------------------------------------------------------------
@@ -31,9 +32,19 @@ StartProcess(char *filename)
 	return;
     }
     space = new AddrSpace(executable);    
-    currentThread->space = space;
 
+#ifndef VM
     delete executable;			// close file
+#endif					// (with VM, the address space keeps 
+					// it, to load pages on demand)
+    if (!space->IsValid()) {
+	printf("Unable to run %s\n", filename);
+	delete space;
+	return;
+    }
+    currentThread->space = space;
+    currentThread->pcb = new PCB(currentThread);
+    currentThread->pcb->setSpace(space);
 
     space->InitRegisters();		// set the initial register values
     space->RestoreState();		// load page table register
@@ -0,0 +1,143 @@
+// synchconsole.cc
+//	Routines to synchronously access the console.  The console is
+//	an asynchronous device (requests return immediately, and an
+//	interrupt happens later on).  This is a layer on top of the
+//	console providing a synchronous interface (requests wait until
+//	the request completes).
+//
+//	Use a semaphore to synchronize each interrupt handler with the
+//	waiting thread, and a lock for each direction, so that one
+//	program's Write isn't interleaved with another's.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "synchconsole.h"
+
+//----------------------------------------------------------------------
+// ConsoleReadAvail
+// ConsoleWriteDone
+// 	Console interrupt handlers.  Need this to be a C routine, because
+//	C++ can't handle pointers to member functions.
+//----------------------------------------------------------------------
+
+static void
+ConsoleReadAvail(int arg)
+{
+    SynchConsole *console = (SynchConsole *)arg;
+
+    console->ReadAvail();
+}
+
+static void
+ConsoleWriteDone(int arg)
+{
+    SynchConsole *console = (SynchConsole *)arg;
+
+    console->WriteDone();
+}
+
+//----------------------------------------------------------------------
+// SynchConsole::SynchConsole
+// 	Initialize the synchronous interface to the console, in turn
+//	initializing the console.
+//
+//	"readFile" -- UNIX file simulating the keyboard (NULL -> use stdin)
+//	"writeFile" -- UNIX file simulating the display (NULL -> use stdout)
+//----------------------------------------------------------------------
+
+SynchConsole::SynchConsole(char *readFile, char *writeFile)
+{
+    readAvail = new Semaphore("console read avail", 0);
+    writeDone = new Semaphore("console write done", 0);
+    readLock = new Lock("console read lock");
+    writeLock = new Lock("console write lock");
+    console = new Console(readFile, writeFile, ConsoleReadAvail,
+				ConsoleWriteDone, (int) this);
+}
+
+//----------------------------------------------------------------------
+// SynchConsole::~SynchConsole
+// 	De-allocate data structures needed for the synchronous console
+//	abstraction.
+//----------------------------------------------------------------------
+
+SynchConsole::~SynchConsole()
+{
+    delete console;
+    delete writeLock;
+    delete readLock;
+    delete writeDone;
+    delete readAvail;
+}
+
+//----------------------------------------------------------------------
+// SynchConsole::Read
+// 	Read characters typed at the console, waiting until there is at
+//	least one.  Stop after a newline, so a program reading a line at
+//	a time doesn't wait for input that hasn't been typed yet.
+//
+//	Returns the number of characters read.
+//
+//	"into" -- the buffer to put the characters in
+//	"size" -- the most characters to read
+//----------------------------------------------------------------------
+
+int
+SynchConsole::Read(char *into, int size)
+{
+    int numRead = 0;
+
+    readLock->Acquire();		// only one console read at a time
+    while (numRead < size) {
+	readAvail->P();			// wait for a character to arrive
+	into[numRead] = console->GetChar();
+	if (into[numRead++] == '\n')
+	    break;
+    }
+    readLock->Release();
+    return numRead;
+}
+
+//----------------------------------------------------------------------
+// SynchConsole::Write
+// 	Write characters to the console display, waiting for each one to
+//	go out before starting the next.
+//
+//	"from" -- the characters to write
+//	"size" -- how many
+//----------------------------------------------------------------------
+
+void
+SynchConsole::Write(char *from, int size)
+{
+    int i;
+
+    writeLock->Acquire();		// only one console write at a time
+    for (i = 0; i < size; i++) {
+	console->PutChar(from[i]);
+	writeDone->P();			// wait for interrupt
+    }
+    writeLock->Release();
+}
+
+//----------------------------------------------------------------------
+// SynchConsole::ReadAvail
+// SynchConsole::WriteDone
+// 	Console interrupt handlers.  Wake up the thread waiting for the
+//	character.
+//----------------------------------------------------------------------
+
+void
+SynchConsole::ReadAvail()
+{
+    readAvail->V();
+}
+
+void
+SynchConsole::WriteDone()
+{
+    writeDone->V();
+}
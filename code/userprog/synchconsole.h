@@ -0,0 +1,49 @@
+// synchconsole.h
+//	Data structures to export a synchronous interface to the console
+//	device.  The console hardware is asynchronous: PutChar returns
+//	at once and an interrupt says when the character is out, and an
+//	interrupt says when a character has come in.  This layer makes
+//	a thread wait for those interrupts, and lets only one thread at a
+//	time read, and one at a time write.
+//
+//	This is what user programs' Read and Write on ConsoleInput and
+//	ConsoleOutput go through.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef SYNCHCONSOLE_H
+#define SYNCHCONSOLE_H
+
+#include "copyright.h"
+#include "console.h"
+#include "synch.h"
+
+// The following class defines a "synchronous" console abstraction.
+
+class SynchConsole {
+  public:
+    SynchConsole(char *readFile, char *writeFile);
+    					// Initialize the console device;
+					// NULL means stdin and stdout
+    ~SynchConsole();			// De-allocate the console device
+
+    int Read(char *into, int size);	// Read up to "size" characters,
+					// waiting for at least one, and
+					// stopping after a newline
+    void Write(char *from, int size);	// Write "size" characters, waiting
+					// until they are all out
+
+    void ReadAvail();			// Called by the interrupt handlers
+    void WriteDone();			// to wake up waiting threads
+
+  private:
+    Console *console;			// the hardware
+    Semaphore *readAvail;		// a character has come in
+    Semaphore *writeDone;		// a character has gone out
+    Lock *readLock;			// one reader at a time
+    Lock *writeLock;			// one writer at a time
+};
+
+#endif // SYNCHCONSOLE_H
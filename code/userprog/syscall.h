@@ -29,6 +29,9 @@
 #define SC_Close	8
 #define SC_Fork		9
 #define SC_Yield	10
+#define SC_ReadV	11
+#define SC_WriteV	12
+#define SC_ThreadFork	13
 
 #ifndef IN_ASM
 
@@ -55,9 +58,19 @@ void Exit(int status);
 typedef int SpaceId;	
  
 /* Run the executable, stored in the Nachos file "name", and return the 
- * address space identifier
+ * address space identifier, or -1 if it can't be run.  "argv" is a 
+ * null-terminated list of at most MaxArgs arguments, each shorter than
+ * MaxArgSize, passed to the program's main(argc, argv); it may be 0,
+ * for none.  The arguments are put on the new program's stack, so 
+ * altogether -- the strings, rounded up to words, and a word for each
+ * pointer to them -- they must take less than MaxArgBytes.
  */
-SpaceId Exec(char *name);
+
+#define MaxArgs		16
+#define MaxArgSize	128
+#define MaxArgBytes	512	/* half of the stack (see addrspace.h) */
+
+SpaceId Exec(char *name, char **argv);
  
 /* Only return once the the user program "id" has finished.  
  * Return the exit status.
@@ -108,16 +121,41 @@ int Read(char *buffer, int size, OpenFileId id);
 /* Close the file, we're done reading and writing to it. */
 void Close(OpenFileId id);
 
+/* Scatter/gather I/O: Read into, or Write from, "count" buffers in 
+ * order, in a single system call.  Cheaper than a Read or Write per 
+ * buffer, since the kernel can do one large transfer for all of them.
+ * Return the number of bytes transferred, or -1 if a buffer or "id"
+ * is bad.  At most MaxIOVecs buffers.
+ */
+
+#define MaxIOVecs	16
+
+typedef struct {
+    char *buffer;		/* where the data is */
+    int size;			/* how many bytes */
+} IOVec;
+
+int ReadV(IOVec *vecs, int count, OpenFileId id);
+int WriteV(IOVec *vecs, int count, OpenFileId id);
 
 
-/* User-level thread operations: Fork and Yield.  To allow multiple
- * threads to run within a user program. 
+
+/* Fork a new process to run a procedure ("func"), in a copy of the
+ * current address space.  If "func" returns, the process exits.
+ */
+void Fork(void (*func)());
+
+
+/* User-level thread operations: ThreadFork and Yield.  To allow multiple
+ * threads to run within a user program.  Exit ends only the calling 
+ * thread; the program ends when its last thread exits.
  */
 
 /* Fork a thread to run a procedure ("func") in the *same* address space 
- * as the current thread.
+ * as the current thread, on its own stack.  If "func" returns, the 
+ * thread exits.  Returns -1 if there are too many threads.
  */
-void Fork(void (*func)());
+int ThreadFork(void (*func)());
 
 /* Yield the CPU to another runnable thread, whether in this address space 
  * or not. 
@@ -0,0 +1,179 @@
+// usermem.cc
+//	Routines to copy data in and out of the current user program's
+//	address space, a page at a time.  See usermem.h.
+//
+//	We let the machine translate the addresses, so that the page
+//	table (or TLB), and its use and dirty bits, are treated exactly as
+//	for the user program's own loads and stores.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "system.h"
+#include "usermem.h"
+#include "addrspace.h"
+#ifdef HOST_SPARC
+#include <strings.h>
+#endif
+
+//----------------------------------------------------------------------
+// ResolveFault
+// 	Do whatever it takes to make an address usable again, after an
+//	exception on it: bring the page in (or zero-fill it), load the
+//	TLB, or give a copy-on-write page its own frame.
+//
+//	Called both for the user program's own faults (from 
+//	ExceptionHandler) and for faults in the routines below.
+//
+//	Returns FALSE if the address is not legal for the access.
+//
+//	"which" -- the exception, PageFaultException or ReadOnlyException
+//	"badVAddr" -- the address that faulted
+//----------------------------------------------------------------------
+
+bool
+ResolveFault(ExceptionType which, int badVAddr)
+{
+    AddrSpace *space = currentThread->space;
+    int vpn = (unsigned) badVAddr / PageSize;
+
+    if (which == PageFaultException) {
+#ifdef VM
+	if (!space->PageIn(vpn))
+	    return FALSE;
+#ifdef USE_TLB
+	tlbManager->Refill(space, vpn);
+#endif
+	return TRUE;
+#else
+	return space->ZeroFill(vpn);
+#endif
+    }
+#ifndef VM
+    if (which == ReadOnlyException)
+	return space->CopyOnWrite(vpn);
+#endif
+    return FALSE;
+}
+
+//----------------------------------------------------------------------
+// TranslateUser
+// 	Find the physical address of a byte of the user program, handling
+//	any faults along the way.  Returns -1 if the address is bad.
+//
+//	"virtAddr" -- the address in the user program
+//	"writing" -- TRUE if the kernel is about to write there
+//----------------------------------------------------------------------
+
+static int
+TranslateUser(int virtAddr, bool writing)
+{
+    ExceptionType exception;
+    int physAddr, tries;
+
+    // A fault is handled, and the translation retried.  With a TLB, 
+    // the page may need both a refill and a copy-on-write, and might
+    // even be paged out again before we look, so allow a few tries.
+    for (tries = 0; tries < 4; tries++) {
+	exception = machine->Translate(virtAddr, &physAddr, 1, writing);
+	if (exception == NoException)
+	    return physAddr;
+	if (!ResolveFault(exception, virtAddr))
+	    return -1;
+    }
+    return -1;
+}
+
+//----------------------------------------------------------------------
+// CopyIn
+// 	Copy data from the user program into the kernel.
+//
+//	"virtAddr" -- where the data is in the user program
+//	"into" -- where to put it
+//	"size" -- how many bytes
+//----------------------------------------------------------------------
+
+bool
+CopyIn(int virtAddr, char *into, int size)
+{
+    int physAddr, chunk;
+
+    while (size > 0) {
+	physAddr = TranslateUser(virtAddr, FALSE);
+	if (physAddr == -1)
+	    return FALSE;
+	chunk = min(size, (int) (PageSize - ((unsigned) virtAddr % PageSize)));
+	bcopy(&(machine->mainMemory[physAddr]), into, chunk);
+	virtAddr += chunk;
+	into += chunk;
+	size -= chunk;
+    }
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// CopyOut
+// 	Copy data from the kernel into the user program.  Any instructions
+//	the machine has decoded from the pages written are thrown away.
+//
+//	"from" -- where the data is in the kernel
+//	"virtAddr" -- where to put it in the user program
+//	"size" -- how many bytes
+//----------------------------------------------------------------------
+
+bool
+CopyOut(char *from, int virtAddr, int size)
+{
+    int physAddr, chunk;
+
+    while (size > 0) {
+	physAddr = TranslateUser(virtAddr, TRUE);
+	if (physAddr == -1)
+	    return FALSE;
+	chunk = min(size, (int) (PageSize - ((unsigned) virtAddr % PageSize)));
+	bcopy(from, &(machine->mainMemory[physAddr]), chunk);
+	machine->InvalidateDecodeCache(physAddr / PageSize);
+	virtAddr += chunk;
+	from += chunk;
+	size -= chunk;
+    }
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// CopyInString
+// 	Copy a null-terminated string from the user program into the
+//	kernel.  Returns the length of the string (not counting the null),
+//	or -1 if the address is bad, or the string doesn't fit.
+//
+//	"virtAddr" -- where the string is in the user program
+//	"into" -- where to put it
+//	"maxSize" -- room at "into", including the null
+//----------------------------------------------------------------------
+
+int
+CopyInString(int virtAddr, char *into, int maxSize)
+{
+    int physAddr, chunk, length = 0;
+    char *start, *end;
+
+    while (length < maxSize) {
+	physAddr = TranslateUser(virtAddr, FALSE);
+	if (physAddr == -1)
+	    return -1;
+	chunk = min(maxSize - length, 
+			(int) (PageSize - ((unsigned) virtAddr % PageSize)));
+	start = &(machine->mainMemory[physAddr]);
+	end = (char *) memchr(start, '\0', chunk);
+	if (end != NULL) {			// found the end of the string
+	    bcopy(start, into + length, end - start + 1);
+	    return length + (end - start);
+	}
+	bcopy(start, into + length, chunk);
+	virtAddr += chunk;
+	length += chunk;
+    }
+    return -1;					// too long
+}
@@ -0,0 +1,45 @@
+// usermem.h
+//	Routines for the kernel to move data between its own memory and
+//	the address space of the current user program -- for example,
+//	the buffer passed to a Read or Write system call, or the name
+//	passed to Open.
+//
+//	The data is moved a page at a time: each page is translated once
+//	and its part of the data copied with a single bcopy, rather than
+//	a ReadMem or WriteMem per byte.  If a page isn't in memory (or is
+//	copy-on-write), the fault is handled just as if the user program
+//	had touched it, and the copy goes on; if the address is bad, the
+//	routine fails instead of killing Nachos.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef USERMEM_H
+#define USERMEM_H
+
+#include "copyright.h"
+#include "machine.h"
+
+extern bool CopyIn(int virtAddr, char *into, int size);
+					// Copy "size" bytes from the user
+					// program at "virtAddr".  FALSE if
+					// the address is bad.
+extern bool CopyOut(char *from, int virtAddr, int size);
+					// Copy "size" bytes to the user
+					// program at "virtAddr".  FALSE if
+					// the address is bad.
+extern int CopyInString(int virtAddr, char *into, int maxSize);
+					// Copy a null-terminated string
+					// from the user program, at most
+					// "maxSize" bytes counting the null.
+					// Returns its length, or -1 if the
+					// address is bad or it's too long.
+
+extern bool ResolveFault(ExceptionType which, int badVAddr);
+					// Handle a page fault or write to a
+					// read-only page at "badVAddr" in 
+					// the current address space.  FALSE
+					// if the access is illegal.
+
+#endif // USERMEM_H
@@ -0,0 +1,109 @@
+// backingstore.cc
+//	Routines to manage the swap file, where virtual pages go when
+//	they are evicted from main memory.
+//
+//	The swap file is an ordinary file, so it lives in the UNIX file
+//	system with FILESYS_STUB, and on the simulated disk with FILESYS.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "backingstore.h"
+#include "bitmap.h"
+#include "system.h"
+
+//----------------------------------------------------------------------
+// BackingStore::BackingStore
+// 	Initialize a backing store of "size" pages, all free.
+//	The swap file itself isn't created until the first page is
+//	written out, so programs that fit in memory never touch the disk.
+//----------------------------------------------------------------------
+
+BackingStore::BackingStore(int size)
+{
+    numSlots = size;
+    file = NULL;
+    slots = new BitMap(numSlots);
+}
+
+//----------------------------------------------------------------------
+// BackingStore::~BackingStore
+// 	Close the swap file, if we ever made one, and throw it away.
+//----------------------------------------------------------------------
+
+BackingStore::~BackingStore()
+{
+    if (file != NULL) {
+	delete file;
+	fileSystem->Remove(SwapFileName);
+    }
+    delete slots;
+}
+
+//----------------------------------------------------------------------
+// BackingStore::AllocSlot
+// 	Reserve a page-sized slot in the swap file.  Returns the slot #,
+//	or -1 if the swap file is full.
+//----------------------------------------------------------------------
+
+int
+BackingStore::AllocSlot()
+{
+    if (file == NULL) {
+	if (!fileSystem->Create(SwapFileName, numSlots * PageSize)) {
+	    printf("Unable to create swap file %s\n", SwapFileName);
+	    ASSERT(FALSE);
+	}
+	file = fileSystem->Open(SwapFileName);
+	ASSERT(file != NULL);
+    }
+    return slots->Find();
+}
+
+//----------------------------------------------------------------------
+// BackingStore::FreeSlot
+// 	Give back a slot, when the page that was in it goes away.
+//----------------------------------------------------------------------
+
+void
+BackingStore::FreeSlot(int slot)
+{
+    ASSERT(slots->Test(slot));
+    slots->Clear(slot);
+}
+
+//----------------------------------------------------------------------
+// BackingStore::PageOut
+// 	Write the contents of a physical frame to a slot of the swap file.
+//
+//	"slot" -- where to put the page; must have been allocated
+//	"frame" -- the physical frame to write out
+//----------------------------------------------------------------------
+
+void
+BackingStore::PageOut(int slot, int frame)
+{
+    ASSERT(slots->Test(slot));
+    DEBUG('a', "Writing frame %d to swap slot %d\n", frame, slot);
+    file->WriteAt(&(machine->mainMemory[frame * PageSize]), PageSize,
+							slot * PageSize);
+}
+
+//----------------------------------------------------------------------
+// BackingStore::PageIn
+// 	Read a slot of the swap file into a physical frame.
+//
+//	"slot" -- where the page was written out
+//	"frame" -- the physical frame to fill
+//----------------------------------------------------------------------
+
+void
+BackingStore::PageIn(int slot, int frame)
+{
+    ASSERT(slots->Test(slot));
+    DEBUG('a', "Reading swap slot %d into frame %d\n", slot, frame);
+    file->ReadAt(&(machine->mainMemory[frame * PageSize]), PageSize,
+							slot * PageSize);
+}
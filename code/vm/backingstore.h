@@ -0,0 +1,51 @@
+// backingstore.h
+//	Data structures for the backing store -- the place on disk where
+//	virtual pages are kept while they are not in main memory.
+//
+//	The backing store is a single file (the swap file), divided into
+//	page-sized slots.  A page gets a slot the first time it has to be
+//	written out, and keeps it until its address space goes away.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef BACKINGSTORE_H
+#define BACKINGSTORE_H
+
+#include "copyright.h"
+#include "filesys.h"
+
+class BitMap;
+
+#define SwapFileName	"SWAP"
+
+#ifdef FILESYS_STUB
+#define NumSwapPages	1024	// size of the swap file, in pages
+#else
+#include "filehdr.h"
+#define NumSwapPages	(MaxFileSize / PageSize)
+				// as big as a Nachos file can be
+#endif
+
+// The following class defines the swap file, and which of its slots
+// are in use.
+
+class BackingStore {
+  public:
+    BackingStore(int size);	// Initialize; all slots free
+    ~BackingStore();		// Close and remove the swap file
+
+    int AllocSlot();		// Reserve a slot; -1 if the file is full
+    void FreeSlot(int slot);	// Give back a slot
+
+    void PageOut(int slot, int frame);	// Copy a frame to a slot
+    void PageIn(int slot, int frame);	// Copy a slot to a frame
+
+  private:
+    OpenFile *file;		// the swap file; NULL until first needed
+    BitMap *slots;		// which slots are in use
+    int numSlots;		// how many slots the file holds
+};
+
+#endif // BACKINGSTORE_H
@@ -0,0 +1,265 @@
+// frametable.cc
+//	Routines to manage the physical page frames of main memory, for
+//	demand-paged virtual memory.
+//
+//	Frames are handed out free while there are any.  After that,
+//	each new page takes the frame of a victim page chosen by the
+//	replacement policy (see frametable.h), which its address space
+//	first writes to the backing store if it has to.
+//
+//	NOTE: the caller must hold "lock" across AllocFrame and the filling
+//	of the frame, so that two page faults can't pick the same frame.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "system.h"
+#include "frametable.h"
+#include "addrspace.h"
+#include "synch.h"
+
+//----------------------------------------------------------------------
+// FrameTable::FrameTable
+// 	Initialize the frame table; to start with, every frame is free.
+//
+//	"size" is the number of physical frames to manage; the 
+//		frames above that are left unused.
+//	"which" is how to choose a page to evict when memory is full.
+//----------------------------------------------------------------------
+
+FrameTable::FrameTable(int size, ReplacementPolicy which)
+{
+    int i;
+
+    ASSERT((size > 0) && (size <= NumPhysPages));
+    numFrames = size;
+    policy = which;
+    frames = new FrameInfo[numFrames];
+    for (i = 0; i < numFrames; i++) {
+	frames[i].space = NULL;
+	frames[i].virtualPage = -1;
+	frames[i].entry = NULL;
+	frames[i].loadTime = 0;
+	frames[i].age = 0;
+	frames[i].lastUse = 0;
+    }
+    numLoads = 0;
+    hand = 0;
+    lock = new Lock("frame table");
+}
+
+//----------------------------------------------------------------------
+// FrameTable::~FrameTable
+// 	De-allocate the frame table.
+//----------------------------------------------------------------------
+
+FrameTable::~FrameTable()
+{
+    delete [] frames;
+    delete lock;
+}
+
+//----------------------------------------------------------------------
+// FrameTable::AllocFrame
+// 	Find a physical frame to hold a virtual page.  If there are no
+//	free frames, take one away from the page that has been in memory
+//	the longest; its address space saves it if needed.
+//
+//	Returns the frame number.  The frame's old contents are left in
+//	place; it is up to the caller to fill it in.
+//
+//	"space" -- the address space the page belongs to
+//	"virtualPage" -- the page that will be brought into the frame
+//----------------------------------------------------------------------
+
+int
+FrameTable::AllocFrame(AddrSpace *space, int virtualPage)
+{
+    int frame;
+
+    ASSERT(lock->isHeldByCurrentThread());
+#ifdef USE_TLB
+    tlbManager->SyncBits();		// the TLB has the latest use bits
+#endif
+    if (policy == LRUReplace)
+	UpdateAges();
+    for (frame = 0; frame < numFrames; frame++)
+	if (frames[frame].space == NULL)
+	    break;
+    if (frame == numFrames) {			// memory is full
+	frame = ChooseVictim();
+	DEBUG('a', "Evicting page %d from frame %d\n",
+				frames[frame].virtualPage, frame);
+	frames[frame].space->PageOut(frames[frame].virtualPage);
+    }
+    frames[frame].space = space;
+    frames[frame].virtualPage = virtualPage;
+    frames[frame].entry = space->PageEntry(virtualPage);
+    frames[frame].loadTime = numLoads++;
+    frames[frame].age = (unsigned) 1 << 31;	// as if just used
+    frames[frame].lastUse = stats->totalTicks;
+    return frame;
+}
+
+//----------------------------------------------------------------------
+// FrameTable::FreeFrame
+// 	Mark a frame as free, when its address space goes away.
+//
+//	"frame" -- the frame to free
+//----------------------------------------------------------------------
+
+void
+FrameTable::FreeFrame(int frame)
+{
+    ASSERT((frame >= 0) && (frame < numFrames));
+    frames[frame].space = NULL;
+    frames[frame].virtualPage = -1;
+    frames[frame].entry = NULL;
+}
+
+//----------------------------------------------------------------------
+// FrameTable::ChooseVictim
+// 	Return the in-use frame to take away, according to the 
+//	replacement policy.  Only called when every frame is in use.
+//----------------------------------------------------------------------
+
+int
+FrameTable::ChooseVictim()
+{
+    switch (policy) {
+      case ClockReplace:
+	return ClockVictim();
+      case LRUReplace:
+	return LRUVictim();
+      case WorkingSetReplace:
+	return WorkingSetVictim();
+      case FIFOReplace:
+      default:
+	return FIFOVictim();
+    }
+}
+
+//----------------------------------------------------------------------
+// FrameTable::FIFOVictim
+// 	Return the frame whose page was brought in longest ago.
+//----------------------------------------------------------------------
+
+int
+FrameTable::FIFOVictim()
+{
+    int frame, victim = 0;
+
+    for (frame = 1; frame < numFrames; frame++)
+	if ((int) (frames[frame].loadTime - frames[victim].loadTime) < 0)
+	    victim = frame;
+    return victim;
+}
+
+//----------------------------------------------------------------------
+// FrameTable::ClockVictim
+// 	Sweep the frames, starting at the clock hand, for a page that
+//	hasn't been used since the hand last went by.  The first lap
+//	looks for a page that is also clean, without touching anything;
+//	the second takes a dirty one, clearing use bits as it goes, so
+//	that a third lap and a fourth are sure to find something.
+//----------------------------------------------------------------------
+
+int
+FrameTable::ClockVictim()
+{
+    int lap, i, frame;
+    TranslationEntry *entry;
+
+    for (lap = 0; ; lap++) {
+	for (i = 0; i < numFrames; i++) {
+	    frame = (hand + i) % numFrames;
+	    entry = frames[frame].entry;
+	    if (!entry->use && (entry->dirty == (lap % 2 == 1))) {
+		hand = (frame + 1) % numFrames;
+		return frame;
+	    }
+	    if (lap % 2 == 1)
+		entry->use = FALSE;		// second chance
+	}
+	ASSERT(lap < 4);
+    }
+}
+
+//----------------------------------------------------------------------
+// FrameTable::UpdateAges
+// 	Shift each frame's age right by one, putting its use bit in at
+//	the top, and clear the use bit.  Called at every page fault, so
+//	a page's age records whether it was used between each of the
+//	last 32 faults.
+//----------------------------------------------------------------------
+
+void
+FrameTable::UpdateAges()
+{
+    int frame;
+    TranslationEntry *entry;
+
+    for (frame = 0; frame < numFrames; frame++) {
+	entry = frames[frame].entry;
+	if (entry == NULL)
+	    continue;
+	frames[frame].age >>= 1;
+	if (entry->use)
+	    frames[frame].age |= (unsigned) 1 << 31;
+	entry->use = FALSE;
+    }
+}
+
+//----------------------------------------------------------------------
+// FrameTable::LRUVictim
+// 	Return the frame with the smallest age -- roughly, the one used
+//	least recently.  Ties go to the page brought in first.
+//----------------------------------------------------------------------
+
+int
+FrameTable::LRUVictim()
+{
+    int frame, victim = 0;
+
+    for (frame = 1; frame < numFrames; frame++)
+	if ((frames[frame].age < frames[victim].age) ||
+		((frames[frame].age == frames[victim].age) &&
+		((int) (frames[frame].loadTime - frames[victim].loadTime) < 0)))
+	    victim = frame;
+    return victim;
+}
+
+//----------------------------------------------------------------------
+// FrameTable::WorkingSetVictim
+// 	Sweep the frames, starting at the clock hand, noting the time of
+//	every page whose use bit is set (and clearing it).  Return the
+//	first page that has fallen out of the working set -- not used
+//	for WorkingSetWindow ticks.  If every page is in the working set,
+//	return the one that has gone unused the longest.
+//----------------------------------------------------------------------
+
+int
+FrameTable::WorkingSetVictim()
+{
+    int i, frame, oldest = -1;
+    int now = stats->totalTicks;
+    TranslationEntry *entry;
+
+    for (i = 0; i < numFrames; i++) {
+	frame = (hand + i) % numFrames;
+	entry = frames[frame].entry;
+	if (entry->use) {
+	    frames[frame].lastUse = now;
+	    entry->use = FALSE;
+	} else if (now - frames[frame].lastUse > WorkingSetWindow) {
+	    hand = (frame + 1) % numFrames;
+	    return frame;
+	}
+	if ((oldest == -1) || (frames[frame].lastUse < frames[oldest].lastUse))
+	    oldest = frame;
+    }
+    hand = (oldest + 1) % numFrames;
+    return oldest;
+}
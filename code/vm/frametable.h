@@ -0,0 +1,99 @@
+// frametable.h
+//	Data structures to keep track of the physical page frames of
+//	main memory, on behalf of demand-paged virtual memory.
+//
+//	There is one frame table for the whole machine.  For every frame
+//	it records which address space and which virtual page is living
+//	there, so that when memory is full, a victim can be chosen and
+//	written out to the backing store by its owner.
+//
+//	How the victim is chosen is up to the replacement policy:
+//
+//	FIFO -- the page that was brought in longest ago
+//	Clock -- second chance: sweep the frames in order, skipping (and
+//		clearing) pages whose use bit is set, and preferring clean
+//		pages to dirty ones, which cost a disk write
+//	LRU -- an approximation: each frame has an age, shifted right at
+//		every page fault with the use bit coming in at the top;
+//		the page with the smallest age goes
+//	WorkingSet -- WSClock: sweep as for Clock, but take a page only
+//		if it hasn't been used for WorkingSetWindow ticks; if
+//		every page is in the working set, take the one unused the
+//		longest
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef FRAMETABLE_H
+#define FRAMETABLE_H
+
+#include "copyright.h"
+#include "utility.h"
+#include "translate.h"
+
+class AddrSpace;
+class Lock;
+
+// The page replacement policies.
+
+enum ReplacementPolicy { FIFOReplace, ClockReplace, LRUReplace, 
+			 WorkingSetReplace };
+
+#define WorkingSetWindow	5000	// ticks a page stays in the working
+					// set after it was last used
+
+// The following class defines the bookkeeping for one physical frame.
+
+class FrameInfo {
+  public:
+    AddrSpace *space;		// address space using the frame, or NULL
+				// if the frame is free
+    int virtualPage;		// which of its pages is in the frame
+    TranslationEntry *entry;	// its translation; we look at (and
+				// clear) the use and dirty bits
+    unsigned int loadTime;	// when the page was brought in (counts
+				// page-ins, not ticks), for FIFO
+    unsigned int age;		// use bits at recent page faults, most
+				// recent on top, for LRU
+    int lastUse;		// last time (in ticks) the page was seen
+				// to be used, for WorkingSet
+};
+
+// The following class defines the frame table -- the owner of every
+// physical frame, and the policy for choosing which frame to take
+// away when there are no free ones.
+
+class FrameTable {
+  public:
+    FrameTable(int size, ReplacementPolicy which);
+				// Initialize the table; all frames free
+    ~FrameTable();		// De-allocate the table
+
+    int AllocFrame(AddrSpace *space, int virtualPage);
+				// Find a frame for "virtualPage" of
+				// "space", paging out whatever was in
+				// it if necessary.  Returns the frame #.
+    void FreeFrame(int frame);	// Give back a frame; its page is gone
+
+    Lock *lock;			// held while a page is being moved in or
+				// out, so no one else picks the same frame
+
+  private:
+    int ChooseVictim();		// Pick the frame to take away, according
+				// to the replacement policy
+    int FIFOVictim();
+    int ClockVictim();
+    int LRUVictim();
+    int WorkingSetVictim();
+    void UpdateAges();		// Sample the use bits, for LRU
+
+    FrameInfo *frames;		// one entry per physical frame
+    int numFrames;		// how many frames we manage
+    ReplacementPolicy policy;	// how to choose a victim
+    unsigned int numLoads;	// page-ins so far, to stamp loadTime
+    int hand;			// where the Clock and WorkingSet sweeps
+				// start next time
+};
+
+#endif // FRAMETABLE_H
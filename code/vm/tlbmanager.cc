@@ -0,0 +1,277 @@
+// tlbmanager.cc
+//	Routines to refill the TLB on a miss, and to keep the page tables
+//	up to date with what the machine records in the TLB.
+//
+//	When every entry of the TLB is in use, the one replaced is chosen
+//	at random, first-in first-out, or least recently used.  The
+//	machine doesn't time TLB references, so LRU is approximate: at
+//	every refill, each entry whose use bit is set is stamped with
+//	the time (the refill count), and its use bit is cleared.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "system.h"
+#include "tlbmanager.h"
+#include "addrspace.h"
+
+//----------------------------------------------------------------------
+// TLBManager::TLBManager
+// 	Initialize the kernel's TLB bookkeeping.  The TLB itself starts
+//	out empty (see Machine::Machine).
+//
+//	"which" is how to choose an entry to replace on a miss.
+//----------------------------------------------------------------------
+
+TLBManager::TLBManager(TLBPolicy which)
+{
+    int i;
+
+    ASSERT(machine->tlb != NULL);
+    policy = which;
+    for (i = 0; i < NumASIDs; i++)
+	asidOwner[i] = NULL;
+    nextASID = 0;
+    loadTime = new unsigned int[machine->tlbSize];
+    lastUse = new unsigned int[machine->tlbSize];
+    for (i = 0; i < machine->tlbSize; i++)
+	loadTime[i] = lastUse[i] = 0;
+    numRefills = 0;
+}
+
+//----------------------------------------------------------------------
+// TLBManager::~TLBManager
+// 	De-allocate the TLB bookkeeping.
+//----------------------------------------------------------------------
+
+TLBManager::~TLBManager()
+{
+    delete [] loadTime;
+    delete [] lastUse;
+}
+
+//----------------------------------------------------------------------
+// TLBManager::Activate
+// 	Called when an address space is switched in.  If it doesn't
+//	still have an ASID from the last time it ran, give it one --
+//	a free one if there is any, otherwise one taken back (and
+//	flushed) from another address space.  Then point the machine
+//	at it.  Nothing is flushed when an address space keeps its ASID.
+//
+//	"space" -- the address space about to run
+//----------------------------------------------------------------------
+
+void
+TLBManager::Activate(AddrSpace *space)
+{
+    int i, asid;
+
+    if ((space->asid == -1) || (asidOwner[space->asid] != space)) {
+	asid = nextASID;
+	for (i = 0; i < NumASIDs; i++)
+	    if (asidOwner[(nextASID + i) % NumASIDs] == NULL) {
+		asid = (nextASID + i) % NumASIDs;
+		break;
+	    }
+	nextASID = (asid + 1) % NumASIDs;
+	if (asidOwner[asid] != NULL) {		// none free; take it back
+	    DEBUG('a', "Recycling ASID %d\n", asid);
+	    FlushASID(asid);
+	    asidOwner[asid]->asid = -1;
+	}
+	asidOwner[asid] = space;
+	space->asid = asid;
+    }
+    machine->currentASID = space->asid;
+}
+
+//----------------------------------------------------------------------
+// TLBManager::Release
+// 	Called when an address space is being de-allocated; flush its
+//	entries, and free its ASID for someone else.
+//
+//	"space" -- the address space going away
+//----------------------------------------------------------------------
+
+void
+TLBManager::Release(AddrSpace *space)
+{
+    if ((space->asid == -1) || (asidOwner[space->asid] != space))
+	return;
+    FlushASID(space->asid);
+    asidOwner[space->asid] = NULL;
+    space->asid = -1;
+}
+
+//----------------------------------------------------------------------
+// TLBManager::Refill
+// 	Load the page table entry for a virtual page into the TLB,
+//	replacing some other entry if there is no free one.
+//
+//	If the page isn't in memory (it may have been paged out again
+//	since the fault was handled), leave the TLB alone; the user
+//	instruction will just fault again.
+//
+//	"space" -- the address space that missed; must be the current one
+//	"virtualPage" -- the page it missed on
+//----------------------------------------------------------------------
+
+void
+TLBManager::Refill(AddrSpace *space, int virtualPage)
+{
+    TranslationEntry *entry = space->PageEntry(virtualPage);
+    TranslationEntry *slot;
+    int i;
+
+    ASSERT(space->asid == machine->currentASID);
+    if (!entry->valid)
+	return;
+    if (policy == LRUTLB)
+	SyncBits();			// sample which entries were used
+
+    i = ChooseSlot();
+    slot = &machine->tlb[i];
+    if (slot->valid)
+	WriteBack(i);
+    DEBUG('a', "TLB entry %d <- virtual page %d, frame %d, ASID %d\n",
+			i, virtualPage, entry->physicalPage, space->asid);
+    *slot = *entry;
+    slot->use = FALSE;		// the TLB only records what happens
+    slot->dirty = FALSE;	// from now on
+    slot->asid = space->asid;
+    loadTime[i] = lastUse[i] = numRefills++;
+}
+
+//----------------------------------------------------------------------
+// TLBManager::InvalidatePage
+// 	Flush the TLB entry for a virtual page, if there is one, copying
+//	its use and dirty bits to the page table first.  Must be called
+//	before a page leaves memory, so the machine stops using its frame,
+//	and so the page table knows whether the page is dirty.
+//
+//	"space" -- the address space the page belongs to
+//	"virtualPage" -- the page
+//----------------------------------------------------------------------
+
+void
+TLBManager::InvalidatePage(AddrSpace *space, int virtualPage)
+{
+    TranslationEntry *slot;
+    int i;
+
+    if ((space->asid == -1) || (asidOwner[space->asid] != space))
+	return;				// no entries at all
+    for (i = 0; i < machine->tlbSize; i++) {
+	slot = &machine->tlb[i];
+	if (slot->valid && (slot->asid == space->asid)
+			&& (slot->virtualPage == virtualPage)) {
+	    WriteBack(i);
+	    slot->valid = FALSE;
+	}
+    }
+}
+
+//----------------------------------------------------------------------
+// TLBManager::SyncBits
+// 	Copy the use and dirty bits of every TLB entry back to the page
+//	tables, so that the page replacement policy sees them.  The use
+//	bits in the TLB are cleared, so that they show use since this
+//	call; this is also the sampling point for LRU.
+//----------------------------------------------------------------------
+
+void
+TLBManager::SyncBits()
+{
+    TranslationEntry *slot;
+    int i;
+
+    for (i = 0; i < machine->tlbSize; i++) {
+	slot = &machine->tlb[i];
+	if (!slot->valid)
+	    continue;
+	WriteBack(i);
+	if (slot->use)
+	    lastUse[i] = numRefills;
+	slot->use = FALSE;
+    }
+}
+
+//----------------------------------------------------------------------
+// TLBManager::ChooseSlot
+// 	Return the TLB entry to load a new translation into: a free one
+//	if there is any, otherwise one chosen by the replacement policy.
+//----------------------------------------------------------------------
+
+int
+TLBManager::ChooseSlot()
+{
+    int i, victim;
+
+    for (i = 0; i < machine->tlbSize; i++)
+	if (!machine->tlb[i].valid)
+	    return i;
+
+    switch (policy) {
+      case FIFOTLB:
+	victim = 0;
+	for (i = 1; i < machine->tlbSize; i++)
+	    if ((int) (loadTime[i] - loadTime[victim]) < 0)
+		victim = i;
+	return victim;
+      case LRUTLB:
+	victim = 0;
+	for (i = 1; i < machine->tlbSize; i++)
+	    if ((int) (lastUse[i] - lastUse[victim]) < 0)
+		victim = i;
+	return victim;
+      case RandomTLB:
+      default:
+	return Random() % machine->tlbSize;
+    }
+}
+
+//----------------------------------------------------------------------
+// TLBManager::WriteBack
+// 	Copy the use and dirty bits of a TLB entry to the page table
+//	entry it was loaded from.  The bits are or'ed in, so the page
+//	table keeps anything it already knew.
+//
+//	"i" -- the TLB entry; must be valid
+//----------------------------------------------------------------------
+
+void
+TLBManager::WriteBack(int i)
+{
+    TranslationEntry *slot = &machine->tlb[i];
+    TranslationEntry *entry;
+
+    ASSERT(slot->valid && (asidOwner[slot->asid] != NULL));
+    entry = asidOwner[slot->asid]->PageEntry(slot->virtualPage);
+    ASSERT(entry->valid && (entry->physicalPage == slot->physicalPage));
+    if (slot->use)
+	entry->use = TRUE;
+    if (slot->dirty)
+	entry->dirty = TRUE;
+}
+
+//----------------------------------------------------------------------
+// TLBManager::FlushASID
+// 	Invalidate every TLB entry belonging to an ASID, copying back
+//	their use and dirty bits first.
+//
+//	"asid" -- the ASID to flush
+//----------------------------------------------------------------------
+
+void
+TLBManager::FlushASID(int asid)
+{
+    int i;
+
+    for (i = 0; i < machine->tlbSize; i++)
+	if (machine->tlb[i].valid && (machine->tlb[i].asid == asid)) {
+	    WriteBack(i);
+	    machine->tlb[i].valid = FALSE;
+	}
+}
@@ -0,0 +1,76 @@
+// tlbmanager.h
+//	Data structures for managing the software-loaded TLB.
+//
+//	With USE_TLB, the machine translates addresses only through its
+//	TLB; every miss raises a PageFaultException, and the kernel
+//	refills the TLB from the address space's page table (paging the
+//	page in first if it isn't in memory).
+//
+//	Each TLB entry is tagged with an address space id (ASID), so a
+//	context switch only has to change machine->currentASID, not
+//	flush the TLB.  ASIDs are handed out to address spaces as they
+//	are switched in; when they run out, one is taken back from
+//	another address space, whose entries are flushed then.
+//
+//	The machine sets the use and dirty bits in the TLB entry, not
+//	the page table, so they are copied back to the page table when
+//	the entry is replaced, and before the frame table looks at them.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef TLBMANAGER_H
+#define TLBMANAGER_H
+
+#include "copyright.h"
+#include "utility.h"
+#include "translate.h"
+
+class AddrSpace;
+
+#define NumASIDs	64		// as on the MIPS R3000
+
+// How to choose the TLB entry to replace on a miss, when none are free.
+
+enum TLBPolicy { RandomTLB, FIFOTLB, LRUTLB };
+
+// The following class defines the kernel's side of the TLB.
+
+class TLBManager {
+  public:
+    TLBManager(TLBPolicy which);	// Initialize; no ASIDs in use
+    ~TLBManager();
+
+    void Activate(AddrSpace *space);	// Make "space" the one the TLB
+					// translates for (on a context
+					// switch), giving it an ASID
+    void Release(AddrSpace *space);	// Flush and give back the ASID
+					// of an address space going away
+
+    void Refill(AddrSpace *space, int virtualPage);
+					// Load the translation for a page
+					// that is in memory, after a miss
+    void InvalidatePage(AddrSpace *space, int virtualPage);
+					// Flush a page's entry, if any,
+					// because it is leaving memory
+    void SyncBits();			// Copy the use and dirty bits back
+					// to the page tables
+
+  private:
+    int ChooseSlot();			// Pick the entry to replace
+    void WriteBack(int slot);		// Copy an entry's use and dirty
+					// bits to its page table entry
+    void FlushASID(int asid);		// Invalidate every entry of an ASID
+
+    TLBPolicy policy;
+    AddrSpace *asidOwner[NumASIDs];	// who has each ASID, or NULL
+    int nextASID;			// where to look for the next ASID
+    unsigned int *loadTime;		// per entry, when it was loaded (FIFO)
+    unsigned int *lastUse;		// per entry, when it was last seen
+					// to be used (LRU)
+    unsigned int numRefills;		// refills so far, the clock for
+					// loadTime and lastUse
+};
+
+#endif // TLBMANAGER_H